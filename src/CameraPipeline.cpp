@@ -0,0 +1,221 @@
+#include "CameraPipeline.h"
+#include <chrono>
+#include <iostream>
+
+static FrameSourceOptions cameraOptions(const PipelineConfig& config) {
+    FrameSourceOptions options;
+    options.width = config.capture_width;
+    options.height = config.capture_height;
+    options.fps = config.capture_fps;
+    return options;
+}
+
+static std::string cameraLabel(const FrameSource* source) {
+    return metricLabel("camera", source ? source->describe() : "external");
+}
+
+CameraPipeline::CameraPipeline(int camera_idx,
+                               std::shared_ptr<SharedDetector> detector,
+                               PipelineConfig config)
+    : CameraPipeline(std::make_unique<CameraSource>(camera_idx, cameraOptions(config)),
+                     std::move(detector), config) {}
+
+CameraPipeline::CameraPipeline(std::unique_ptr<FrameSource> source,
+                               std::shared_ptr<SharedDetector> detector,
+                               PipelineConfig config)
+    : source_(std::move(source))
+    , detector_(std::move(detector))
+    , config_(config)
+    , lossless_(source_ && !source_->isLive())
+    , keyframes_(config.keyframes)
+    , frames_captured_(MetricsRegistry::instance().counter(
+          "visionary_frames_captured_total", "Frames read from a source", cameraLabel(source_.get())))
+    , frames_dropped_(MetricsRegistry::instance().counter(
+          "visionary_frames_dropped_total", "Frames dropped before inference", cameraLabel(source_.get())))
+    , frames_detected_(MetricsRegistry::instance().counter(
+          "visionary_frames_detected_total", "Keyframes that ran through the detector", cameraLabel(source_.get())))
+    , frames_redetected_(MetricsRegistry::instance().counter(
+          "visionary_frames_redetected_total", "Frames between keyframes re-detected in crops around the tracks",
+          cameraLabel(source_.get())))
+    , inference_errors_(MetricsRegistry::instance().counter(
+          "visionary_inference_errors_total", "Frames whose detection failed and were predicted instead",
+          cameraLabel(source_.get())))
+    , capture_depth_(MetricsRegistry::instance().gauge(
+          "visionary_queue_depth", "Items waiting in a pipeline queue",
+          cameraLabel(source_.get()) + "," + metricLabel("queue", "capture")))
+    , detection_depth_(MetricsRegistry::instance().gauge(
+          "visionary_queue_depth", "Items waiting in a pipeline queue",
+          cameraLabel(source_.get()) + "," + metricLabel("queue", "detection")))
+    , capture_time_(MetricsRegistry::instance().histogram(
+          "visionary_capture_seconds", "Time one read of a source blocks, including waiting for the frame",
+          cameraLabel(source_.get())))
+    , frame_pool_(2 * config.queue_capacity + 6 + config.reserved_frames,
+                  cv::Size(config.capture_width, config.capture_height))
+    , capture_queue_(config.queue_capacity, lossless_ ? OverflowPolicy::Block : config.capture_policy)
+    , detection_queue_(config.queue_capacity, lossless_ ? OverflowPolicy::Block : config.detection_policy) {}
+
+std::string CameraPipeline::describe() const {
+    return source_ ? source_->describe() : "external source";
+}
+
+CameraPipeline::~CameraPipeline() {
+    stop();
+}
+
+void CameraPipeline::start() {
+    stop_ = false;
+    if (source_) capture_thread_ = std::thread(&CameraPipeline::captureLoop, this);
+    inference_thread_ = std::thread(&CameraPipeline::inferenceLoop, this);
+    tracking_thread_ = std::thread(&CameraPipeline::trackingLoop, this);
+}
+
+void CameraPipeline::stop() {
+    stop_ = true;
+    capture_done_ = true;
+    inference_done_ = true;
+    if (source_) source_->interrupt();
+    for (auto* thread : {&capture_thread_, &inference_thread_, &tracking_thread_}) {
+        if (thread->joinable()) thread->join();
+    }
+}
+
+void CameraPipeline::submit(CapturedFrame&& frame) {
+    const uint64_t dropped_before = capture_queue_.dropped();
+    capture_queue_.push(std::move(frame), stop_);
+    const uint64_t dropped = capture_queue_.dropped() - dropped_before;
+    if (dropped > 0) frames_dropped_.add(dropped);
+    capture_depth_.set(static_cast<int64_t>(capture_queue_.size()));
+}
+
+bool CameraPipeline::decideKeyframe(const cv::Mat& frame, CameraPipeline& partner) {
+    if (partner.keyframes_.takeKeyframeRequest()) keyframes_.requestKeyframe();
+    return keyframes_.isKeyframe(frame);
+}
+
+bool CameraPipeline::fetchLatest(Output& out) {
+    if (!has_new_output_.load(std::memory_order_acquire)) return false;
+
+    std::lock_guard<std::mutex> lock(output_mutex_);
+    std::swap(out, latest_);
+    has_new_output_.store(false, std::memory_order_release);
+    return true;
+}
+
+void CameraPipeline::captureLoop() {
+    if (!source_->open()) {
+        std::cerr << "Failed to open " << source_->describe() << std::endl;
+    } else {
+        uint64_t sequence = 0;
+        while (!stop_) {
+            FrameHandle frame = frame_pool_.acquire();
+            if (!frame) {
+                if (lossless_) {
+                    // a recording waits for a free slot, nothing may be dropped
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    continue;
+                }
+                // every slot is still referenced downstream, drain the camera and drop this frame
+                source_->skip();
+                pool_exhausted_.fetch_add(1, std::memory_order_relaxed);
+                frames_dropped_.add();
+                continue;
+            }
+
+            CapturedFrame captured;
+            const auto read_start = std::chrono::steady_clock::now();
+            const bool got_frame = source_->read(frame.mat(), captured.capture_ns);
+            capture_time_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - read_start).count());
+
+            if (got_frame) {
+                frames_captured_.add();
+                captured.sequence = sequence++;
+                captured.frame = std::move(frame);
+                if (capture_sink_) {
+                    capture_sink_(std::move(captured));
+                } else {
+                    submit(std::move(captured));
+                }
+                continue;
+            }
+
+            // end of a recording
+            if (!source_->isLive() || stop_) break;
+
+            std::cerr << source_->describe() << " read error!" << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+
+    capture_ended_.store(true, std::memory_order_release);
+    if (!capture_sink_) capture_done_.store(true, std::memory_order_release);
+}
+
+void CameraPipeline::inferenceLoop() {
+    CapturedFrame captured;
+    int consecutive_failures = 0;
+    while (!stop_ && capture_queue_.pop(captured, capture_done_)) {
+        capture_depth_.set(static_cast<int64_t>(capture_queue_.size()));
+        DetectedFrame detected;
+        detected.keyframe = captured.keyframe ? *captured.keyframe : keyframes_.isKeyframe(captured.frame.mat());
+        try {
+            if (detected.keyframe) {
+                detected.detections = detector_->detect(captured.frame.mat());
+                frames_detected_.add();
+            } else if (keyframes_.regionsOfInterest(captured.frame.mat().size(), regions_)) {
+                detected.detections = detector_->detect(captured.frame.mat(), regions_);
+                frames_redetected_.add();
+            } else {
+                detected.predicted = true;
+            }
+            consecutive_failures = 0;
+        } catch (const std::exception& e) {
+            // the tracker coasts over the frame and the next one retries the detector
+            inference_errors_.add();
+            std::cerr << describe() << ": inference failed: " << e.what() << std::endl;
+            detected.detections.clear();
+            detected.predicted = true;
+            keyframes_.requestKeyframe();
+            if (++consecutive_failures >= MAX_CONSECUTIVE_FAILURES) {
+                std::cerr << describe() << ": " << consecutive_failures
+                          << " inference failures in a row, stopping this camera" << std::endl;
+                stop_ = true;
+                break;
+            }
+        }
+        detected.captured = std::move(captured);
+        if (!detection_queue_.push(std::move(detected), stop_)) break;
+        detection_depth_.set(static_cast<int64_t>(detection_queue_.size()));
+    }
+    inference_done_.store(true, std::memory_order_release);
+}
+
+void CameraPipeline::trackingLoop() {
+    DetectedFrame detected;
+    // cycles through latest_ and the consumer's Output via swaps, so its capacity is kept
+    std::vector<TrackingResult> tracks;
+    while (!stop_ && detection_queue_.pop(detected, inference_done_)) {
+        detection_depth_.set(static_cast<int64_t>(detection_queue_.size()));
+        if (detected.predicted) {
+            tracker_.predict(tracks);
+        } else {
+            tracker_.update(detected.detections, tracks);
+        }
+        keyframes_.setTracks(tracks, detected.captured.frame.mat().size(), tracker_.predictionDrift());
+
+        // a recording hands over every frame: wait until the previous one was fetched
+        while (lossless_ && has_new_output_.load(std::memory_order_acquire) && !stop_) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+
+        std::lock_guard<std::mutex> lock(output_mutex_);
+        latest_.frame = std::move(detected.captured.frame);
+        latest_.capture_ns = detected.captured.capture_ns;
+        latest_.sequence = detected.captured.sequence;
+        latest_.keyframe = detected.keyframe;
+        latest_.detections = std::move(detected.detections);
+        std::swap(latest_.tracks, tracks);
+        has_new_output_.store(true, std::memory_order_release);
+    }
+    finished_.store(true, std::memory_order_release);
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "FramePool.h"
+#include "FrameSource.h"
+#include "KeyframeScheduler.h"
+#include "Metrics.h"
+#include "OCSortTracker.h"
+#include "RingBuffer.h"
+#include "SharedDetector.h"
+
+struct PipelineConfig {
+    size_t queue_capacity = 2;
+    OverflowPolicy capture_policy = OverflowPolicy::DropOldest;   // capture -> inference
+    OverflowPolicy detection_policy = OverflowPolicy::Block;      // inference -> tracking
+    int capture_width = 640;       // live cameras opened by index
+    int capture_height = 480;
+    int capture_fps = 30;
+    size_t reserved_frames = 4;    // frames parked outside the pipeline, e.g. in a synchronizer
+    KeyframeOptions keyframes;     // disabled: every frame goes through the detector
+};
+
+// capture -> inference -> tracking, each stage on its own thread, so capture of frame N+1
+// overlaps inference of frame N and throughput follows the slowest stage
+class CameraPipeline {
+public:
+    struct Output {
+        FrameHandle frame;
+        int64_t capture_ns = 0;
+        uint64_t sequence = 0;
+        bool keyframe = true;      // false: detections only near the tracks, or none if they were predicted
+        std::vector<YoloDetector::Detection> detections;
+        std::vector<TrackingResult> tracks;
+    };
+
+    CameraPipeline(int camera_idx,
+                   std::shared_ptr<SharedDetector> detector,
+                   PipelineConfig config = {});
+
+    // recorded sources are processed without losses: the queues block instead of dropping and
+    // every tracked frame waits until it was fetched. a null source is fed through submit()
+    CameraPipeline(std::unique_ptr<FrameSource> source,
+                   std::shared_ptr<SharedDetector> detector,
+                   PipelineConfig config = {});
+    ~CameraPipeline();
+
+    CameraPipeline(const CameraPipeline&) = delete;
+    CameraPipeline& operator=(const CameraPipeline&) = delete;
+
+    // by default captured frames go straight to inference; a sink can intercept them
+    // (e.g. a synchronizer) and hand them back through submit(). set before start().
+    using CaptureSink = std::function<void(CapturedFrame&&)>;
+    void setCaptureSink(CaptureSink sink) { capture_sink_ = std::move(sink); }
+
+    // queues a frame for inference; calls must come from one thread at a time
+    void submit(CapturedFrame&& frame);
+
+    // one keyframe decision for a stereo pair: this pipeline's scheduler decides on its frame, and
+    // a keyframe the partner asked for (prediction drift, too many tracks for crops) counts too.
+    // the caller tags both frames through CapturedFrame::keyframe, one call at a time
+    bool decideKeyframe(const cv::Mat& frame, CameraPipeline& partner);
+
+    // with a capture sink the pipeline can't know when the sink's last submit() happened;
+    // the owner closes the input once captureEnded() holds for every pipeline feeding the sink
+    void closeInput() { capture_done_.store(true, std::memory_order_release); }
+    bool captureEnded() const { return capture_ended_.load(std::memory_order_acquire); }
+
+    void start();
+    void stop();
+
+    bool hasNewOutput() const { return has_new_output_.load(std::memory_order_acquire); }
+
+    // moves the latest tracked frame into out, false if nothing new since the last fetch
+    bool fetchLatest(Output& out);
+
+    uint64_t droppedFrames() const { return capture_queue_.dropped() + pool_exhausted_.load(); }
+
+    // a recorded source is exhausted and its last frame was fetched
+    bool finished() const { return finished_.load(std::memory_order_acquire) && !hasNewOutput(); }
+
+private:
+    struct DetectedFrame {
+        CapturedFrame captured;
+        bool keyframe = true;
+        bool predicted = false;    // the detector skipped the frame
+        std::vector<YoloDetector::Detection> detections;
+    };
+
+    std::unique_ptr<FrameSource> source_;
+    std::shared_ptr<SharedDetector> detector_;
+    const PipelineConfig config_;
+    const bool lossless_;
+    OCSortTracker tracker_;
+    KeyframeScheduler keyframes_;
+    std::vector<cv::Rect> regions_;     // inference thread only
+
+    // exported per source, labelled with its description
+    Counter& frames_captured_;
+    Counter& frames_dropped_;
+    Counter& frames_detected_;
+    Counter& frames_redetected_;
+    Counter& inference_errors_;
+    Gauge& capture_depth_;
+    Gauge& detection_depth_;
+    LatencyHistogram& capture_time_;
+
+    // enough slots for both queues, one frame inside every stage and one held by the consumer
+    FramePool frame_pool_;
+    std::atomic<uint64_t> pool_exhausted_{0};
+
+    CaptureSink capture_sink_;
+    RingBuffer<CapturedFrame> capture_queue_;
+    RingBuffer<DetectedFrame> detection_queue_;
+
+    std::mutex output_mutex_;
+    Output latest_;
+    std::atomic<bool> has_new_output_{false};
+
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> capture_ended_{false};
+    std::atomic<bool> capture_done_{false};     // nothing more will be queued for inference
+    std::atomic<bool> inference_done_{false};
+    std::atomic<bool> finished_{false};
+    std::thread capture_thread_;
+    std::thread inference_thread_;
+    std::thread tracking_thread_;
+
+    // a detector that failed this many frames in a row is considered broken
+    static constexpr int MAX_CONSECUTIVE_FAILURES = 30;
+
+    std::string describe() const;
+    void captureLoop();
+    void inferenceLoop();
+    void trackingLoop();
+};
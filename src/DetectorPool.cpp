@@ -0,0 +1,52 @@
+#include "DetectorPool.h"
+#include <algorithm>
+#include <future>
+#include <iostream>
+#include <thread>
+
+DetectorPool::DetectorPool(const std::string& model_path, size_t camera_count, size_t size, size_t max_batch,
+                           InferenceOptions inference) {
+    camera_count = std::max<size_t>(1, camera_count);
+    if (size == 0) size = defaultSize(camera_count);
+    size = std::min(size, camera_count);
+
+    // contiguous blocks of cameras per detector
+    cameras_per_detector_ = (camera_count + size - 1) / size;
+    size = (camera_count + cameras_per_detector_ - 1) / cameras_per_detector_;
+    if (max_batch == 0) max_batch = cameras_per_detector_;
+
+    // each onnx runtime session defaults to a thread per core, several of them would oversubscribe
+    if (inference.engine == InferenceEngine::OnnxRuntime && inference.threads == 0) {
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        inference.threads = static_cast<int>(std::max<size_t>(1, cores / size));
+    }
+
+    // the detectors parse the model in parallel, from one in-memory copy of the file
+    std::vector<std::future<std::shared_ptr<YoloDetector>>> loading;
+    for (size_t i = 0; i < size; i++) {
+        loading.push_back(std::async(std::launch::async, [&model_path, inference] {
+            return std::make_shared<YoloDetector>(model_path, 0.4f, 0.4f, YoloDetector::PreprocessMode::Letterbox,
+                                                  inference);
+        }));
+    }
+    detectors_.reserve(size);
+    for (auto& detector : loading) {
+        detectors_.push_back(std::make_shared<SharedDetector>(detector.get(), max_batch));
+    }
+
+    std::cout << "Detector pool: " << size << " detector(s) for " << camera_count << " camera(s)" << std::endl;
+}
+
+std::shared_ptr<SharedDetector> DetectorPool::detectorFor(size_t camera) const {
+    return detectors_[std::min(camera / cameras_per_detector_, detectors_.size() - 1)];
+}
+
+void DetectorPool::stop() {
+    for (auto& detector : detectors_) detector->stop();
+}
+
+size_t DetectorPool::defaultSize(size_t camera_count) {
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    const size_t by_cores = std::max<size_t>(1, cores / THREADS_PER_DETECTOR);
+    return std::min(by_cores, std::max<size_t>(1, camera_count));
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "SharedDetector.h"
+
+// a few batching detectors shared round-robin by many cameras. every detector holds its own
+// network: a cv::dnn::Net keeps per-forward state and can't be shared between threads, so with
+// the opencv engines each detector also holds its own copy of the weights. the pool is sized to
+// the cores available rather than to the number of cameras; a smaller pool trades throughput
+// for memory
+class DetectorPool {
+public:
+    // size 0 picks defaultSize(camera_count), max_batch 0 batches all cameras of one detector.
+    // without an explicit thread count, onnx runtime detectors split the cores between them
+    DetectorPool(const std::string& model_path, size_t camera_count, size_t size = 0, size_t max_batch = 0,
+                 InferenceOptions inference = {});
+
+    DetectorPool(const DetectorPool&) = delete;
+    DetectorPool& operator=(const DetectorPool&) = delete;
+
+    // camera i always gets the same detector, neighbouring cameras (stereo rigs) share one so
+    // their frames can be batched together
+    std::shared_ptr<SharedDetector> detectorFor(size_t camera) const;
+
+    size_t size() const { return detectors_.size(); }
+    void stop();
+
+    static size_t defaultSize(size_t camera_count);
+
+private:
+    std::vector<std::shared_ptr<SharedDetector>> detectors_;
+    size_t cameras_per_detector_;
+
+    // opencv's dnn backend already spreads one forward pass over several threads
+    static constexpr unsigned THREADS_PER_DETECTOR = 4;
+};
@@ -0,0 +1,41 @@
+#include "EpipolarIndex.h"
+#include <numeric>
+
+void EpipolarIndex::build(const float* cx, const float* cy, int count, float bucket_height) {
+    bucket_count_ = 0;
+    if (count == 0) return;
+
+    bucket_height_ = std::max(bucket_height, 1.0f);
+    min_y_ = *std::min_element(cy, cy + count);
+    const float max_y = *std::max_element(cy, cy + count);
+    bucket_count_ = static_cast<int>((max_y - min_y_) / bucket_height_) + 1;
+
+    // counting sort into row buckets
+    bucket_offsets_.assign(bucket_count_ + 1, 0);
+    entry_bucket_.resize(count);
+    for (int i = 0; i < count; ++i) {
+        entry_bucket_[i] = bucketOf(cy[i]);
+        bucket_offsets_[entry_bucket_[i] + 1]++;
+    }
+    std::partial_sum(bucket_offsets_.begin(), bucket_offsets_.end(), bucket_offsets_.begin());
+
+    entry_index_.resize(count);
+    bucket_cursor_.assign(bucket_offsets_.begin(), bucket_offsets_.end() - 1);
+    for (int i = 0; i < count; ++i) {
+        entry_index_[bucket_cursor_[entry_bucket_[i]]++] = i;
+    }
+
+    // x-order inside each bucket for the disparity range lookup
+    for (int bucket = 0; bucket < bucket_count_; ++bucket) {
+        std::sort(entry_index_.begin() + bucket_offsets_[bucket],
+                  entry_index_.begin() + bucket_offsets_[bucket + 1],
+                  [cx](int a, int b) { return cx[a] < cx[b]; });
+    }
+
+    entry_x_.resize(count);
+    entry_y_.resize(count);
+    for (int entry = 0; entry < count; ++entry) {
+        entry_x_[entry] = cx[entry_index_[entry]];
+        entry_y_[entry] = cy[entry_index_[entry]];
+    }
+}
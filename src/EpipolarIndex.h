@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// search window around a left-camera track for rectified cameras
+struct EpipolarBand {
+    float max_vertical_offset = 24.0f;   // |y_right - y_left|
+    float min_disparity = 0.0f;          // x_left - x_right, positive in front of a rectified rig
+    float max_disparity = 640.0f;
+};
+
+// right-camera track centers bucketed by row (bucket height = band height) and sorted by x
+// inside each bucket, so a query touches at most three buckets and a disparity slice of each
+class EpipolarIndex {
+public:
+    void build(const float* cx, const float* cy, int count, float bucket_height);
+
+    // calls fn(right_index) for every indexed track inside the band of (x, y)
+    template<typename Fn>
+    void query(float x, float y, const EpipolarBand& band, Fn&& fn) const {
+        if (bucket_count_ == 0) return;
+
+        const int first = std::max(0, bucketOf(y - band.max_vertical_offset));
+        const int last = std::min(bucket_count_ - 1, bucketOf(y + band.max_vertical_offset));
+        // the right camera sees a point further left, at x - disparity
+        const float min_x = x - band.max_disparity;
+        const float max_x = x - band.min_disparity;
+
+        for (int bucket = first; bucket <= last; ++bucket) {
+            auto begin = entry_x_.begin() + bucket_offsets_[bucket];
+            auto end = entry_x_.begin() + bucket_offsets_[bucket + 1];
+            for (auto it = std::lower_bound(begin, end, min_x); it != end && *it <= max_x; ++it) {
+                const int entry = static_cast<int>(it - entry_x_.begin());
+                if (std::abs(entry_y_[entry] - y) <= band.max_vertical_offset) {
+                    fn(entry_index_[entry]);
+                }
+            }
+        }
+    }
+
+private:
+    float min_y_ = 0.0f;
+    float bucket_height_ = 1.0f;
+    int bucket_count_ = 0;
+
+    std::vector<int> bucket_offsets_;
+    std::vector<int> entry_index_;
+    std::vector<float> entry_x_;
+    std::vector<float> entry_y_;
+    std::vector<int> entry_bucket_;
+    std::vector<int> bucket_cursor_;
+
+    int bucketOf(float y) const {
+        return static_cast<int>(std::floor((y - min_y_) / bucket_height_));
+    }
+};
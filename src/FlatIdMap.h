@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// open-addressing int -> V map with linear probing, everything in one contiguous slot array.
+// erase uses backward shifting instead of tombstones, so a table that sees constant churn
+// (tracker ids come and go forever) keeps short probe chains and never has to grow.
+template<typename V>
+class FlatIdMap {
+public:
+    static constexpr int EMPTY_KEY = std::numeric_limits<int>::min();
+
+    explicit FlatIdMap(size_t capacity = 64) {
+        reserve(capacity);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    V* find(int key) {
+        if (size_ == 0) return nullptr;
+        for (size_t i = slotFor(key);; i = (i + 1) & mask_) {
+            if (slots_[i].key == key) return &slots_[i].value;
+            if (slots_[i].key == EMPTY_KEY) return nullptr;
+        }
+    }
+
+    const V* find(int key) const {
+        return const_cast<FlatIdMap*>(this)->find(key);
+    }
+
+    // inserts a default value if the key is missing
+    V& operator[](int key) {
+        if ((size_ + 1) * 2 > slots_.size()) rehash(slots_.size() * 2);
+
+        size_t i = slotFor(key);
+        for (; slots_[i].key != EMPTY_KEY; i = (i + 1) & mask_) {
+            if (slots_[i].key == key) return slots_[i].value;
+        }
+        slots_[i].key = key;
+        slots_[i].value = V();
+        size_++;
+        return slots_[i].value;
+    }
+
+    bool erase(int key) {
+        if (size_ == 0) return false;
+        size_t i = slotFor(key);
+        for (; slots_[i].key != key; i = (i + 1) & mask_) {
+            if (slots_[i].key == EMPTY_KEY) return false;
+        }
+        eraseSlot(i);
+        return true;
+    }
+
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const auto& slot : slots_) {
+            if (slot.key != EMPTY_KEY) fn(slot.key, slot.value);
+        }
+    }
+
+    // removes every entry for which pred(key, value) is true
+    template<typename Pred>
+    size_t eraseIf(Pred&& pred) {
+        size_t removed = 0;
+        for (size_t i = 0; i < slots_.size();) {
+            if (slots_[i].key != EMPTY_KEY && pred(slots_[i].key, slots_[i].value)) {
+                // the shift may pull an unvisited entry into slot i, look at it again
+                eraseSlot(i);
+                removed++;
+            } else {
+                i++;
+            }
+        }
+        return removed;
+    }
+
+    void clear() {
+        for (auto& slot : slots_) slot.key = EMPTY_KEY;
+        size_ = 0;
+    }
+
+    void reserve(size_t count) {
+        size_t capacity = 8;
+        while (capacity < count * 2) capacity <<= 1;
+        if (capacity > slots_.size()) rehash(capacity);
+    }
+
+private:
+    struct Slot {
+        int key = EMPTY_KEY;
+        V value{};
+    };
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+
+    size_t slotFor(int key) const {
+        // fibonacci hashing spreads the mostly sequential tracker ids over the table
+        return static_cast<size_t>((static_cast<uint32_t>(key) * 2654435769u) >> 7) & mask_;
+    }
+
+    void eraseSlot(size_t hole) {
+        size_t i = hole;
+        while (true) {
+            i = (i + 1) & mask_;
+            if (slots_[i].key == EMPTY_KEY) break;
+
+            // move the entry back if the hole lies between its home slot and where it sits now
+            const size_t home = slotFor(slots_[i].key);
+            if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+                slots_[hole] = std::move(slots_[i]);
+                hole = i;
+            }
+        }
+        slots_[hole].key = EMPTY_KEY;
+        slots_[hole].value = V();
+        size_--;
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(capacity, Slot());
+        mask_ = capacity - 1;
+        size_ = 0;
+        for (auto& slot : old) {
+            if (slot.key == EMPTY_KEY) continue;
+            size_t i = slotFor(slot.key);
+            while (slots_[i].key != EMPTY_KEY) i = (i + 1) & mask_;
+            slots_[i] = std::move(slot);
+            size_++;
+        }
+    }
+};
@@ -0,0 +1,82 @@
+#include "FramePool.h"
+
+FrameHandle::FrameHandle(const FrameHandle& other)
+    : pool_(other.pool_), index_(other.index_) {
+    if (pool_) pool_->retain(index_);
+}
+
+FrameHandle::FrameHandle(FrameHandle&& other) noexcept
+    : pool_(other.pool_), index_(other.index_) {
+    other.pool_ = nullptr;
+}
+
+FrameHandle& FrameHandle::operator=(const FrameHandle& other) {
+    if (this != &other) {
+        if (other.pool_) other.pool_->retain(other.index_);
+        reset();
+        pool_ = other.pool_;
+        index_ = other.index_;
+    }
+    return *this;
+}
+
+FrameHandle& FrameHandle::operator=(FrameHandle&& other) noexcept {
+    if (this != &other) {
+        reset();
+        pool_ = other.pool_;
+        index_ = other.index_;
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+FrameHandle::~FrameHandle() {
+    reset();
+}
+
+cv::Mat& FrameHandle::mat() const {
+    return pool_->slots_[index_].mat;
+}
+
+void FrameHandle::reset() {
+    if (pool_) {
+        pool_->release(index_);
+        pool_ = nullptr;
+    }
+}
+
+FramePool::FramePool(size_t slot_count, cv::Size frame_size, int type)
+    : slot_count_(slot_count)
+    , slots_(new Slot[slot_count]) {
+    free_slots_.reserve(slot_count);
+    for (size_t i = 0; i < slot_count; ++i) {
+        slots_[i].mat.create(frame_size, type);
+        free_slots_.push_back(static_cast<uint32_t>(slot_count - 1 - i));
+    }
+}
+
+FrameHandle FramePool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_slots_.empty()) return {};
+
+    uint32_t index = free_slots_.back();
+    free_slots_.pop_back();
+    slots_[index].refs.store(1, std::memory_order_relaxed);
+    return FrameHandle(this, index);
+}
+
+size_t FramePool::available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_slots_.size();
+}
+
+void FramePool::retain(uint32_t index) {
+    slots_[index].refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FramePool::release(uint32_t index) {
+    if (slots_[index].refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_slots_.push_back(index);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include <opencv2/core.hpp>
+
+class FramePool;
+
+// reference-counted handle to a pooled frame; the slot goes back to the pool when the
+// last handle is dropped. copying a handle never copies pixels.
+class FrameHandle {
+public:
+    FrameHandle() = default;
+    FrameHandle(const FrameHandle& other);
+    FrameHandle(FrameHandle&& other) noexcept;
+    FrameHandle& operator=(const FrameHandle& other);
+    FrameHandle& operator=(FrameHandle&& other) noexcept;
+    ~FrameHandle();
+
+    explicit operator bool() const { return pool_ != nullptr; }
+    cv::Mat& mat() const;
+
+    void reset();
+
+private:
+    friend class FramePool;
+    FrameHandle(FramePool* pool, uint32_t index) : pool_(pool), index_(index) {}
+
+    FramePool* pool_ = nullptr;
+    uint32_t index_ = 0;
+};
+
+// fixed set of preallocated frames recycled between capture, inference and display.
+// the pool must outlive every handle it gave out.
+class FramePool {
+public:
+    FramePool(size_t slot_count, cv::Size frame_size, int type = CV_8UC3);
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // empty handle when every slot is in use
+    FrameHandle acquire();
+
+    size_t available() const;
+    size_t capacity() const { return slot_count_; }
+
+private:
+    friend class FrameHandle;
+
+    struct Slot {
+        cv::Mat mat;
+        std::atomic<int> refs{0};
+    };
+
+    const size_t slot_count_;
+    std::unique_ptr<Slot[]> slots_;
+    std::vector<uint32_t> free_slots_;
+    mutable std::mutex mutex_;
+
+    void retain(uint32_t index);
+    void release(uint32_t index);
+};
+
+// a pooled frame stamped with its steady-clock capture time
+struct CapturedFrame {
+    FrameHandle frame;
+    int64_t capture_ns = 0;
+    uint64_t sequence = 0;    // per camera, or the pair id once synchronized
+    std::optional<bool> keyframe;   // decided for a whole stereo pair, otherwise by the pipeline
+};
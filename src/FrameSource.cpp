@@ -0,0 +1,228 @@
+#include "FrameSource.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void sleepUntilNs(int64_t deadline_ns) {
+    const int64_t wait_ns = deadline_ns - steadyNowNs();
+    if (wait_ns > 0) std::this_thread::sleep_for(std::chrono::nanoseconds(wait_ns));
+}
+
+std::unique_ptr<FrameSource> FrameSource::create(const std::string& spec, const FrameSourceOptions& options) {
+    if (!spec.empty() && std::all_of(spec.begin(), spec.end(), [](unsigned char c) { return std::isdigit(c); })) {
+        return std::make_unique<CameraSource>(std::stoi(spec), options);
+    }
+    if (std::filesystem::is_directory(spec)) {
+        return std::make_unique<ImageDirectorySource>(spec, options);
+    }
+    return std::make_unique<VideoFileSource>(spec, options);
+}
+
+CameraSource::CameraSource(int camera_idx, const FrameSourceOptions& options)
+    : camera_idx_(camera_idx)
+    , options_(options) {}
+
+bool CameraSource::open() {
+    if (!cap_.open(camera_idx_)) return false;
+    cap_.set(cv::CAP_PROP_FRAME_WIDTH, options_.width);
+    cap_.set(cv::CAP_PROP_FRAME_HEIGHT, options_.height);
+    cap_.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    cap_.set(cv::CAP_PROP_FPS, options_.fps);
+    return true;
+}
+
+bool CameraSource::read(cv::Mat& out, int64_t& capture_ns) {
+    // stamp at grab time, decoding in retrieve() would skew the timestamp
+    if (!cap_.grab()) return false;
+    capture_ns = steadyNowNs();
+    return cap_.retrieve(out) && !out.empty();
+}
+
+std::string CameraSource::describe() const {
+    return "camera " + std::to_string(camera_idx_);
+}
+
+VideoFileSource::VideoFileSource(std::string path, const FrameSourceOptions& options)
+    : path_(std::move(path))
+    , pacing_(options.pacing) {}
+
+bool VideoFileSource::open() {
+    if (!cap_.open(path_)) return false;
+    const double fps = cap_.get(cv::CAP_PROP_FPS);
+    if (fps > 0.0) fps_ = fps;
+    start_wall_ns_ = steadyNowNs();
+    return true;
+}
+
+bool VideoFileSource::read(cv::Mat& out, int64_t& capture_ns) {
+    if (!cap_.read(out) || out.empty()) return false;
+
+    // media time from the frame index: identical on every run, unlike the container's position
+    capture_ns = static_cast<int64_t>(frame_index_++ * 1e9 / fps_);
+    if (pacing_ == Pacing::RealTime) sleepUntilNs(start_wall_ns_ + capture_ns);
+    return true;
+}
+
+ImageDirectorySource::ImageDirectorySource(std::string directory, const FrameSourceOptions& options)
+    : directory_(std::move(directory))
+    , pacing_(options.pacing)
+    , fps_(options.fps > 0.0 ? options.fps : 30.0) {}
+
+bool ImageDirectorySource::open() {
+    static const std::vector<std::string> IMAGE_EXTENSIONS = {".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff"};
+
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory_, error)) {
+        if (!entry.is_regular_file()) continue;
+        std::string extension = entry.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (std::find(IMAGE_EXTENSIONS.begin(), IMAGE_EXTENSIONS.end(), extension) != IMAGE_EXTENSIONS.end()) {
+            files_.push_back(entry.path().string());
+        }
+    }
+    if (error || files_.empty()) return false;
+
+    // zero-padded frame numbers sort correctly by name
+    std::sort(files_.begin(), files_.end());
+    start_wall_ns_ = steadyNowNs();
+    return true;
+}
+
+bool ImageDirectorySource::read(cv::Mat& out, int64_t& capture_ns) {
+    while (next_ < files_.size()) {
+        const size_t index = next_++;
+        cv::Mat image = cv::imread(files_[index], cv::IMREAD_COLOR);
+        if (image.empty()) {
+            std::cerr << "Skipping unreadable image " << files_[index] << std::endl;
+            continue;
+        }
+        image.copyTo(out);
+
+        capture_ns = static_cast<int64_t>(index * 1e9 / fps_);
+        if (pacing_ == Pacing::RealTime) sleepUntilNs(start_wall_ns_ + capture_ns);
+        return true;
+    }
+    return false;
+}
+
+struct StereoFileSource::Shared {
+    struct Pending {
+        cv::Mat frame;
+        int64_t capture_ns = 0;
+    };
+
+    static constexpr size_t MAX_LEAD = 2;
+
+    std::unique_ptr<FrameSource> sources[2];
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Pending> pending[2];
+    std::vector<cv::Mat> spare;     // buffers handed back by the pipelines, reused for pending frames
+    bool opened = false;
+    bool open_ok = false;
+    bool finished = false;
+    bool interrupted = false;
+
+    bool open() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!opened) {
+            opened = true;
+            open_ok = sources[0]->open() && sources[1]->open();
+        }
+        return open_ok;
+    }
+
+    bool read(int side, cv::Mat& out, int64_t& capture_ns) {
+        const int other = 1 - side;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            if (interrupted) return false;
+
+            if (!pending[side].empty()) {
+                Pending& front = pending[side].front();
+                std::swap(out, front.frame);
+                capture_ns = front.capture_ns;
+                spare.push_back(std::move(front.frame));
+                pending[side].pop_front();
+                ready.notify_all();
+                return true;
+            }
+            if (finished) return false;
+
+            if (pending[other].size() >= MAX_LEAD) {
+                ready.wait(lock);
+                continue;
+            }
+
+            // one frame from each file; this side takes its own, the other's is parked
+            Pending parked;
+            if (!spare.empty()) {
+                parked.frame = std::move(spare.back());
+                spare.pop_back();
+            }
+            int64_t own_ns = 0;
+            if (!sources[side]->read(out, own_ns) || !sources[other]->read(parked.frame, parked.capture_ns)) {
+                finished = true;
+                ready.notify_all();
+                return false;
+            }
+
+            // the left file's clock is the pair's clock
+            const int64_t pair_ns = side == 0 ? own_ns : parked.capture_ns;
+            capture_ns = parked.capture_ns = pair_ns;
+            pending[other].push_back(std::move(parked));
+            ready.notify_all();
+            return true;
+        }
+    }
+
+    void interrupt() {
+        std::lock_guard<std::mutex> lock(mutex);
+        interrupted = true;
+        for (auto& source : sources) source->interrupt();
+        ready.notify_all();
+    }
+};
+
+class StereoFileSource::SideView : public FrameSource {
+public:
+    SideView(std::shared_ptr<Shared> shared, int side)
+        : shared_(std::move(shared))
+        , side_(side) {}
+
+    bool open() override { return shared_->open(); }
+    bool read(cv::Mat& out, int64_t& capture_ns) override { return shared_->read(side_, out, capture_ns); }
+    bool isLive() const override { return false; }
+    void interrupt() override { shared_->interrupt(); }
+    std::string describe() const override { return shared_->sources[side_]->describe(); }
+
+private:
+    std::shared_ptr<Shared> shared_;
+    const int side_;
+};
+
+StereoFileSource::StereoFileSource(std::unique_ptr<FrameSource> left, std::unique_ptr<FrameSource> right)
+    : shared_(std::make_shared<Shared>()) {
+    shared_->sources[0] = std::move(left);
+    shared_->sources[1] = std::move(right);
+}
+
+std::unique_ptr<FrameSource> StereoFileSource::left() {
+    return std::make_unique<SideView>(shared_, 0);
+}
+
+std::unique_ptr<FrameSource> StereoFileSource::right() {
+    return std::make_unique<SideView>(shared_, 1);
+}
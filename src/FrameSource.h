@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+enum class Pacing {
+    RealTime,           // recorded input is replayed at its own frame rate
+    AsFastAsPossible    // no waiting on the wall clock, every frame is read back to back
+};
+
+struct FrameSourceOptions {
+    Pacing pacing = Pacing::RealTime;
+    int width = 640;            // live cameras only
+    int height = 480;
+    double fps = 30.0;          // live cameras, and the frame interval of image directories
+};
+
+// where a pipeline's frames come from. read() is called from a single capture thread.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    virtual bool open() = 0;
+
+    // fills out and its capture time, false at the end of the input or on a read error.
+    // live sources stamp with the steady clock, recorded ones with their media time
+    virtual bool read(cv::Mat& out, int64_t& capture_ns) = 0;
+
+    // live sources produce frames whether or not we keep up; recorded ones wait for us,
+    // so nothing of them may be dropped
+    virtual bool isLive() const = 0;
+
+    // drops the next frame without decoding it, when the pipeline has nowhere to put it
+    virtual void skip() {}
+
+    // wakes a read() blocked on another thread; later reads return false
+    virtual void interrupt() {}
+
+    virtual std::string describe() const = 0;
+
+    // "2" opens camera 2, a directory is read as an image sequence, anything else as a video file
+    static std::unique_ptr<FrameSource> create(const std::string& spec, const FrameSourceOptions& options = {});
+};
+
+class CameraSource : public FrameSource {
+public:
+    CameraSource(int camera_idx, const FrameSourceOptions& options = {});
+
+    bool open() override;
+    bool read(cv::Mat& out, int64_t& capture_ns) override;
+    void skip() override { cap_.grab(); }
+    bool isLive() const override { return true; }
+    std::string describe() const override;
+
+private:
+    const int camera_idx_;
+    const FrameSourceOptions options_;
+    cv::VideoCapture cap_;
+};
+
+class VideoFileSource : public FrameSource {
+public:
+    VideoFileSource(std::string path, const FrameSourceOptions& options = {});
+
+    bool open() override;
+    bool read(cv::Mat& out, int64_t& capture_ns) override;
+    bool isLive() const override { return false; }
+    std::string describe() const override { return path_; }
+
+private:
+    const std::string path_;
+    const Pacing pacing_;
+    cv::VideoCapture cap_;
+    double fps_ = 30.0;
+    uint64_t frame_index_ = 0;
+    int64_t start_wall_ns_ = 0;
+};
+
+class ImageDirectorySource : public FrameSource {
+public:
+    ImageDirectorySource(std::string directory, const FrameSourceOptions& options = {});
+
+    bool open() override;
+    bool read(cv::Mat& out, int64_t& capture_ns) override;
+    bool isLive() const override { return false; }
+    std::string describe() const override { return directory_; }
+
+private:
+    const std::string directory_;
+    const Pacing pacing_;
+    const double fps_;
+    std::vector<std::string> files_;    // sorted by name
+    size_t next_ = 0;
+    int64_t start_wall_ns_ = 0;
+};
+
+// two recorded inputs read in lockstep, so frame N of both sides carries the same timestamp
+// and a StereoSynchronizer pairs them exactly. each side is handed out as its own source
+// for its pipeline; the faster side waits once it is MAX_LEAD frames ahead.
+class StereoFileSource {
+public:
+    StereoFileSource(std::unique_ptr<FrameSource> left, std::unique_ptr<FrameSource> right);
+
+    std::unique_ptr<FrameSource> left();
+    std::unique_ptr<FrameSource> right();
+
+private:
+    struct Shared;
+    class SideView;
+
+    std::shared_ptr<Shared> shared_;
+};
@@ -0,0 +1,153 @@
+#include "InferenceBackend.h"
+#include <opencv2/opencv.hpp>
+#include <opencv2/core/ocl.hpp>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#ifdef VISIONARY_ONNXRUNTIME
+#include "OnnxRuntimeBackend.h"
+#endif
+
+namespace {
+    bool checkCudaSupport() {
+        int device_count = cv::cuda::getCudaEnabledDeviceCount();
+
+        #ifndef NDEBUG
+                std::cout << "Number of CUDA devices: " << device_count << std::endl;
+        #endif
+
+        if (device_count > 0) {
+            for (int i = 0; i < device_count; ++i) {
+                cv::cuda::printShortCudaDeviceInfo(i);
+            }
+            return true;
+        } else {
+
+        #ifndef NDEBUG
+                    std::cout << "No CUDA-enabled devices found." << std::endl;
+        #endif
+
+        return false;
+        }
+    }
+
+    bool checkOpenCLsupport() {
+        return cv::ocl::haveOpenCL();
+    }
+}
+
+static std::unique_ptr<InferenceBackend> createBackend(const std::string& model_path,
+                                                       const InferenceOptions& options) {
+    switch (options.engine) {
+        case InferenceEngine::OpenCvDnn:
+        case InferenceEngine::OpenVino:
+            return std::make_unique<OpenCvDnnBackend>(model_path, options);
+        case InferenceEngine::OnnxRuntime:
+#ifdef VISIONARY_ONNXRUNTIME
+            return std::make_unique<OnnxRuntimeBackend>(model_path, options);
+#else
+            throw std::runtime_error("ONNX Runtime support is not built in, configure with -DVISIONARY_ONNXRUNTIME=ON");
+#endif
+    }
+    throw std::runtime_error("Unknown inference engine");
+}
+
+std::unique_ptr<InferenceBackend> InferenceBackend::create(const std::string& model_path,
+                                                           const InferenceOptions& options) {
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<InferenceBackend> backend = createBackend(model_path, options);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Loaded " << model_path << " in "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() << " ms ("
+              << backend->describe() << ")" << std::endl;
+    return backend;
+}
+
+std::shared_ptr<const std::vector<uchar>> InferenceBackend::modelBytes(const std::string& model_path) {
+    static std::mutex mutex;
+    static std::map<std::string, std::weak_ptr<const std::vector<uchar>>> loaded;
+
+    // held while reading, so loaders of the same file wait for the first instead of reading it again
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto bytes = loaded[model_path].lock()) return bytes;
+
+    std::ifstream file(model_path, std::ios::binary | std::ios::ate);
+    if (!file) throw std::runtime_error("Failed to load network: can't open " + model_path);
+    auto bytes = std::make_shared<std::vector<uchar>>(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(bytes->data()), static_cast<std::streamsize>(bytes->size()))) {
+        throw std::runtime_error("Failed to load network: can't read " + model_path);
+    }
+    loaded[model_path] = bytes;
+    return bytes;
+}
+
+InferenceEngine InferenceBackend::parseEngine(const std::string& name) {
+    if (name == "opencv") return InferenceEngine::OpenCvDnn;
+    if (name == "openvino") return InferenceEngine::OpenVino;
+    if (name == "onnxruntime") return InferenceEngine::OnnxRuntime;
+    throw std::runtime_error("Unknown inference engine '" + name + "' (opencv, openvino or onnxruntime)");
+}
+
+const char* InferenceBackend::engineName(InferenceEngine engine) {
+    switch (engine) {
+        case InferenceEngine::OpenCvDnn: return "opencv";
+        case InferenceEngine::OpenVino: return "openvino";
+        case InferenceEngine::OnnxRuntime: return "onnxruntime";
+    }
+    return "unknown";
+}
+
+OpenCvDnnBackend::OpenCvDnnBackend(const std::string& model_path, const InferenceOptions& options) {
+    try {
+        const bool onnx = model_path.size() >= 5 && model_path.compare(model_path.size() - 5, 5, ".onnx") == 0;
+        net_ = onnx ? cv::dnn::readNetFromONNX(*modelBytes(model_path)) : cv::dnn::readNet(model_path);
+        output_names_ = net_.getUnconnectedOutLayersNames();
+    } catch (const cv::Exception& e) {
+        throw std::runtime_error("Failed to load network: " + std::string(e.what()));
+    }
+
+    // opencv's thread pool is process-wide, the last detector created sets it for all
+    if (options.threads > 0) cv::setNumThreads(options.threads);
+    if (!options.thread_affinity.empty()) {
+        std::cerr << "Thread affinity is only supported by the onnxruntime engine, ignoring it" << std::endl;
+    }
+
+    if (options.engine == InferenceEngine::OpenVino) {
+        if (cv::dnn::getAvailableTargets(cv::dnn::DNN_BACKEND_INFERENCE_ENGINE).empty()) {
+            throw std::runtime_error("This OpenCV build has no OpenVINO (Inference Engine) backend");
+        }
+        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_INFERENCE_ENGINE);
+        net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        description_ = "opencv dnn / openvino cpu";
+    } else {
+        setBestRuntime();
+    }
+}
+
+void OpenCvDnnBackend::setBestRuntime() {
+    if (checkCudaSupport()) {
+        std::cout << "Utilizing CUDA Runtime" << std::endl;
+        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
+        net_.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
+        description_ = "opencv dnn / cuda";
+    } else if (checkOpenCLsupport()) {
+        // todo: check if working properly
+        std::cout << "No CUDA device found, fallback to OpenCL" << std::endl;
+        net_.setPreferableBackend(cv::dnn::DNN_BACKEND_DEFAULT);
+        net_.setPreferableTarget(cv::dnn::DNN_TARGET_OPENCL);
+        description_ = "opencv dnn / opencl";
+    } else {
+        std::cout << "No CUDA / OpenCL device found, fallback to raw CPU" << std::endl;
+        description_ = "opencv dnn / cpu";
+    }
+}
+
+void OpenCvDnnBackend::infer(const cv::Mat& blob, std::vector<cv::Mat>& outputs) {
+    net_.setInput(blob);
+    net_.forward(outputs, output_names_);
+}
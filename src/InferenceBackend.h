@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+#include "TileLayout.h"
+
+enum class InferenceEngine {
+    OpenCvDnn,      // cv::dnn with the best of CUDA, OpenCL and CPU
+    OpenVino,       // cv::dnn on OpenCV's Inference Engine backend, needs an OpenVINO-enabled OpenCV
+    OnnxRuntime     // ONNX Runtime CPU, needs a build with -DVISIONARY_ONNXRUNTIME=ON
+};
+
+struct InferenceOptions {
+    InferenceEngine engine = InferenceEngine::OpenCvDnn;
+    int threads = 0;                // intra-op threads, 0 leaves the engine's default
+    std::string thread_affinity;    // onnx runtime only: "1,2;3,4" pins intra-op threads 2.. to logical cores
+    TilingOptions tiling;           // applied by YoloDetector around the engine
+};
+
+// runs the network on a preprocessed NCHW float blob. YoloDetector owns preprocessing, decoding
+// and NMS; a backend only wraps the inference engine, so every engine sees identical inputs
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    // outputs receive one Mat per network output; they stay valid until the next call
+    virtual void infer(const cv::Mat& blob, std::vector<cv::Mat>& outputs) = 0;
+
+    virtual std::string describe() const = 0;
+
+    // throws std::runtime_error if the model can't be loaded or the engine isn't built in
+    static std::unique_ptr<InferenceBackend> create(const std::string& model_path, const InferenceOptions& options = {});
+
+    // "opencv", "openvino" or "onnxruntime"; throws std::runtime_error otherwise
+    static InferenceEngine parseEngine(const std::string& name);
+    static const char* engineName(InferenceEngine engine);
+
+    // the model file, read once for every backend that loads it at the same time (e.g. a
+    // detector pool built in parallel); released when the last of them is done parsing. only the
+    // file is shared: each parsed network still owns its weights
+    static std::shared_ptr<const std::vector<uchar>> modelBytes(const std::string& model_path);
+};
+
+class OpenCvDnnBackend : public InferenceBackend {
+public:
+    OpenCvDnnBackend(const std::string& model_path, const InferenceOptions& options);
+
+    void infer(const cv::Mat& blob, std::vector<cv::Mat>& outputs) override;
+    std::string describe() const override { return description_; }
+
+private:
+    cv::dnn::Net net_;
+    std::vector<cv::String> output_names_;
+    std::string description_;
+
+    void setBestRuntime();
+};
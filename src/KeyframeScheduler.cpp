@@ -0,0 +1,108 @@
+#include "KeyframeScheduler.h"
+#include "OCSortTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+KeyframeScheduler::KeyframeScheduler(const KeyframeOptions& options)
+    : options_(options) {
+    track_mask_ = cv::Mat::zeros(THUMB_HEIGHT, THUMB_WIDTH, CV_8U);
+    pending_mask_ = cv::Mat::zeros(THUMB_HEIGHT, THUMB_WIDTH, CV_8U);
+}
+
+bool KeyframeScheduler::isKeyframe(const cv::Mat& frame) {
+    frames_++;
+    if (!options_.enabled) {
+        keyframes_++;
+        return true;
+    }
+
+    cv::resize(frame, small_, cv::Size(THUMB_WIDTH, THUMB_HEIGHT), 0, 0, cv::INTER_AREA);
+    cv::cvtColor(small_, thumbnail_, cv::COLOR_BGR2GRAY);
+
+    bool crowded = false;
+    {
+        std::lock_guard<std::mutex> lock(tracks_mutex_);
+        cv::bitwise_or(track_mask_, pending_mask_, track_mask_);
+        pending_mask_.setTo(0);
+        crowded = options_.roi_redetect && static_cast<int>(track_boxes_.size()) > options_.roi_max_regions;
+    }
+
+    frames_since_keyframe_++;
+    bool keyframe = keyframe_requested_.exchange(false, std::memory_order_relaxed) ||
+                    keyframe_thumbnail_.empty() || crowded ||
+                    frames_since_keyframe_ >= options_.max_interval;
+    if (!keyframe) keyframe = newMotion() > options_.new_object_motion;
+
+    if (keyframe) {
+        // the next thumbnail is written into the old reference, both keep their buffers
+        std::swap(keyframe_thumbnail_, thumbnail_);
+        track_mask_.setTo(0);
+        frames_since_keyframe_ = 0;
+        keyframes_++;
+    }
+    return keyframe;
+}
+
+bool KeyframeScheduler::takeKeyframeRequest() {
+    if (keyframe_requested_.exchange(false, std::memory_order_relaxed)) return true;
+
+    std::lock_guard<std::mutex> lock(tracks_mutex_);
+    return options_.roi_redetect && static_cast<int>(track_boxes_.size()) > options_.roi_max_regions;
+}
+
+// share of thumbnail pixels that changed since the last keyframe where no track has been
+float KeyframeScheduler::newMotion() {
+    cv::absdiff(thumbnail_, keyframe_thumbnail_, difference_);
+
+    int changed = 0;
+    for (int y = 0; y < THUMB_HEIGHT; ++y) {
+        const uchar* delta = difference_.ptr<uchar>(y);
+        const uchar* tracked = track_mask_.ptr<uchar>(y);
+        for (int x = 0; x < THUMB_WIDTH; ++x) {
+            changed += delta[x] > CHANGED_PIXEL_DELTA && !tracked[x];
+        }
+    }
+    return static_cast<float>(changed) / (THUMB_WIDTH * THUMB_HEIGHT);
+}
+
+void KeyframeScheduler::setTracks(const std::vector<TrackingResult>& tracks, cv::Size frame_size,
+                                  float prediction_drift) {
+    if (!options_.enabled || frame_size.area() == 0) return;
+    if (prediction_drift > options_.max_prediction_drift) requestKeyframe();
+
+    const float scale_x = static_cast<float>(THUMB_WIDTH) / frame_size.width;
+    const float scale_y = static_cast<float>(THUMB_HEIGHT) / frame_size.height;
+    const cv::Rect thumb(0, 0, THUMB_WIDTH, THUMB_HEIGHT);
+
+    std::lock_guard<std::mutex> lock(tracks_mutex_);
+    track_boxes_.clear();
+    for (const auto& track : tracks) {
+        track_boxes_.emplace_back(track.x1, track.y1, track.x2 - track.x1, track.y2 - track.y1);
+        // one thumbnail pixel of slack around each box for its blurred edges
+        const int x1 = static_cast<int>(std::floor(track.x1 * scale_x)) - 1;
+        const int y1 = static_cast<int>(std::floor(track.y1 * scale_y)) - 1;
+        const int x2 = static_cast<int>(std::ceil(track.x2 * scale_x)) + 1;
+        const int y2 = static_cast<int>(std::ceil(track.y2 * scale_y)) + 1;
+        const cv::Rect box = cv::Rect(x1, y1, x2 - x1, y2 - y1) & thumb;
+        if (!box.empty()) pending_mask_(box).setTo(255);
+    }
+}
+
+bool KeyframeScheduler::regionsOfInterest(cv::Size frame_size, std::vector<cv::Rect>& regions) {
+    regions.clear();
+    if (!options_.enabled || !options_.roi_redetect) return false;
+
+    const cv::Rect frame(0, 0, frame_size.width, frame_size.height);
+    std::lock_guard<std::mutex> lock(tracks_mutex_);
+    for (const cv::Rect2f& box : track_boxes_) {
+        const float width = std::max(box.width * (1.0f + 2.0f * options_.roi_margin), static_cast<float>(ROI_MIN_SIZE));
+        const float height = std::max(box.height * (1.0f + 2.0f * options_.roi_margin), static_cast<float>(ROI_MIN_SIZE));
+        const cv::Rect region = cv::Rect(static_cast<int>(box.x + 0.5f * (box.width - width)),
+                                         static_cast<int>(box.y + 0.5f * (box.height - height)),
+                                         static_cast<int>(std::ceil(width)),
+                                         static_cast<int>(std::ceil(height))) & frame;
+        if (!region.empty()) regions.push_back(region);
+    }
+    return !regions.empty();
+}
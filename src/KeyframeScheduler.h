@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <opencv2/core.hpp>
+
+struct TrackingResult;
+
+struct KeyframeOptions {
+    bool enabled = false;
+    int max_interval = 5;               // a keyframe at least every N frames
+    float new_object_motion = 0.004f;   // share of changed thumbnail pixels outside all tracks
+    float max_prediction_drift = 0.5f;  // OCSortTracker::predictionDrift() that forces a keyframe
+    bool roi_redetect = false;          // between keyframes, detect in crops around the tracks instead of predicting
+    float roi_margin = 0.5f;            // a crop grows by this share of its box on every side
+    int roi_max_regions = 8;            // with more tracks, full-frame detection is cheaper than the crops
+};
+
+// decides which frames go through the detector. the tracker predicts the frames in between.
+// a frame becomes a keyframe when the interval runs out, when the scene changed where no track
+// explains it (something new may have appeared), or when the tracker asked for one because its
+// predictions drifted too far. the motion check diffs a 80x60 grayscale thumbnail against the
+// last keyframe's, a few microseconds per frame. in ROI mode the frames in between are
+// re-detected in crops around the tracks instead, which falls back to keyframes in crowded scenes
+class KeyframeScheduler {
+public:
+    explicit KeyframeScheduler(const KeyframeOptions& options = {});
+
+    // always true when disabled
+    bool isKeyframe(const cv::Mat& frame);
+
+    // the tracks after the latest update or prediction; motion where they are or have been since
+    // the last keyframe isn't new. a prediction_drift (OCSortTracker::predictionDrift()) above the
+    // limit makes the next frame a keyframe. may be called from another thread than isKeyframe()
+    void setTracks(const std::vector<TrackingResult>& tracks, cv::Size frame_size, float prediction_drift = 0.0f);
+
+    // crops around the latest tracks for re-detecting a frame that isn't a keyframe; false without
+    // tracks or outside ROI mode, then the tracks are predicted
+    bool regionsOfInterest(cv::Size frame_size, std::vector<cv::Rect>& regions);
+
+    // the next frame will be a keyframe
+    void requestKeyframe() { keyframe_requested_.store(true, std::memory_order_relaxed); }
+
+    // for a scheduler whose keyframes another one decides (the right side of a stereo pair): true
+    // once a keyframe was requested, or in ROI mode while there are too many tracks for crops
+    bool takeKeyframeRequest();
+
+    uint64_t keyframes() const { return keyframes_; }
+    uint64_t frames() const { return frames_; }
+
+private:
+    static constexpr int THUMB_WIDTH = 80;
+    static constexpr int THUMB_HEIGHT = 60;
+    static constexpr int CHANGED_PIXEL_DELTA = 24;
+    static constexpr int ROI_MIN_SIZE = 64;    // px, small boxes get some context around them
+
+    const KeyframeOptions options_;
+
+    cv::Mat small_, thumbnail_, keyframe_thumbnail_, difference_;
+    cv::Mat track_mask_;        // everywhere a track has been since the last keyframe
+    int frames_since_keyframe_ = 0;
+    uint64_t keyframes_ = 0;
+    uint64_t frames_ = 0;
+    std::atomic<bool> keyframe_requested_{true};
+
+    std::mutex tracks_mutex_;
+    cv::Mat pending_mask_;      // tracks published since the last isKeyframe()
+    std::vector<cv::Rect2f> track_boxes_;   // of the latest setTracks(), for the crops
+
+    float newMotion();
+};
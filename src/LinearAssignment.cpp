@@ -0,0 +1,207 @@
+#include "LinearAssignment.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+int LinearAssignment::solve(const float* cost, int rows, int cols, float max_cost,
+                            std::vector<int>& row_to_col) {
+    row_to_col.assign(rows, UNASSIGNED);
+    if (rows == 0 || cols == 0) return 0;
+
+    constexpr double INF = std::numeric_limits<double>::infinity();
+
+    // columns 1..cols are real, cols+1..cols+rows are one private "no match" column per row;
+    // index 0 is the virtual root of the augmenting tree (1-based, as in the classic formulation)
+    const int total_cols = cols + rows;
+    auto edge_cost = [&](int row, int col) -> double {
+        if (col <= cols) {
+            const float c = cost[static_cast<size_t>(row - 1) * cols + (col - 1)];
+            return c < max_cost ? c : INF;
+        }
+        return col - cols == row ? max_cost : INF;
+    };
+
+    row_potential_.assign(rows + 1, 0.0);
+    col_potential_.assign(total_cols + 1, 0.0);
+    col_owner_.assign(total_cols + 1, 0);
+    prev_col_.assign(total_cols + 1, 0);
+    min_slack_.resize(total_cols + 1);
+    col_used_.resize(total_cols + 1);
+
+    for (int row = 1; row <= rows; ++row) {
+        col_owner_[0] = row;
+        int col0 = 0;
+        std::fill(min_slack_.begin(), min_slack_.end(), INF);
+        std::fill(col_used_.begin(), col_used_.end(), 0);
+
+        // grow shortest paths (Dijkstra on reduced costs) until a free column is reached
+        do {
+            col_used_[col0] = 1;
+            const int row0 = col_owner_[col0];
+            double delta = INF;
+            int col1 = 0;
+
+            for (int col = 1; col <= total_cols; ++col) {
+                if (col_used_[col]) continue;
+                const double reduced = edge_cost(row0, col) - row_potential_[row0] - col_potential_[col];
+                if (reduced < min_slack_[col]) {
+                    min_slack_[col] = reduced;
+                    prev_col_[col] = col0;
+                }
+                if (min_slack_[col] < delta) {
+                    delta = min_slack_[col];
+                    col1 = col;
+                }
+            }
+
+            for (int col = 0; col <= total_cols; ++col) {
+                if (col_used_[col]) {
+                    row_potential_[col_owner_[col]] += delta;
+                    col_potential_[col] -= delta;
+                } else {
+                    min_slack_[col] -= delta;
+                }
+            }
+            col0 = col1;
+        } while (col_owner_[col0] != 0);
+
+        // flip the augmenting path
+        do {
+            const int col1 = prev_col_[col0];
+            col_owner_[col0] = col_owner_[col1];
+            col0 = col1;
+        } while (col0 != 0);
+    }
+
+    int assigned = 0;
+    for (int col = 1; col <= cols; ++col) {
+        if (col_owner_[col] != 0) {
+            row_to_col[col_owner_[col] - 1] = col - 1;
+            assigned++;
+        }
+    }
+    return assigned;
+}
+
+int LinearAssignment::solve(const SparseCostMatrix& cost, int cols, float max_cost,
+                            std::vector<int>& row_to_col) {
+    const int rows = cost.rows();
+    row_to_col.assign(rows, UNASSIGNED);
+    if (rows == 0) return 0;
+
+    constexpr double INF = std::numeric_limits<double>::infinity();
+    constexpr char OPEN = 1;
+    constexpr char DONE = 2;
+
+    // columns cols..cols+rows-1 are the private "no match" columns, reached only from their row
+    const int total_cols = cols + rows;
+    col_potential_.assign(total_cols, 0.0);
+    col_owner_.assign(total_cols, UNASSIGNED);
+    col_pred_.assign(total_cols, UNASSIGNED);
+    dist_.assign(total_cols, INF);
+    col_used_.assign(total_cols, 0);
+    row_match_.assign(rows, UNASSIGNED);
+    row_match_cost_.assign(rows, 0.0);
+
+    using Entry = std::pair<double, int>;
+    auto& heap = heap_;
+
+    // visits every allowed edge of a row, including its no-match column
+    auto for_each_edge = [&](int row, auto&& fn) {
+        for (int k = cost.row_offsets[row]; k < cost.row_offsets[row + 1]; ++k) {
+            if (cost.costs[k] < max_cost) fn(cost.cols[k], static_cast<double>(cost.costs[k]));
+        }
+        fn(cols + row, static_cast<double>(max_cost));
+    };
+
+    for (int root = 0; root < rows; ++root) {
+        touched_.clear();
+        finalized_.clear();
+        heap.clear();
+
+        auto relax = [&](int col, double d, int row) {
+            if (col_used_[col] == DONE || d >= dist_[col]) return;
+            if (col_used_[col] == 0) {
+                col_used_[col] = OPEN;
+                touched_.push_back(col);
+            }
+            dist_[col] = d;
+            col_pred_[col] = row;
+            heap.emplace_back(d, col);
+            std::push_heap(heap.begin(), heap.end(), std::greater<Entry>());
+        };
+
+        for_each_edge(root, [&](int col, double c) {
+            relax(col, c - col_potential_[col], root);
+        });
+
+        // Dijkstra on reduced costs until the cheapest reachable column is free
+        int free_col = UNASSIGNED;
+        double shortest = 0.0;
+        while (!heap.empty()) {
+            std::pop_heap(heap.begin(), heap.end(), std::greater<Entry>());
+            auto [d, col] = heap.back();
+            heap.pop_back();
+            if (col_used_[col] == DONE || d > dist_[col]) continue;
+
+            col_used_[col] = DONE;
+            finalized_.push_back(col);
+
+            const int owner = col_owner_[col];
+            if (owner == UNASSIGNED) {
+                free_col = col;
+                shortest = d;
+                break;
+            }
+
+            // the owner's edge to col is tight, so its row potential is cost - v[col]
+            const double owner_base = d - (row_match_cost_[owner] - col_potential_[col]);
+            for_each_edge(owner, [&](int next, double c) {
+                relax(next, owner_base + c - col_potential_[next], owner);
+            });
+        }
+
+        // every row owns a no-match column, so a free column is always found
+        for (int col : finalized_) {
+            col_potential_[col] += dist_[col] - shortest;
+        }
+
+        for (int col = free_col; col != UNASSIGNED;) {
+            const int row = col_pred_[col];
+            const int previous = row_match_[row];
+            col_owner_[col] = row;
+            row_match_[row] = col;
+            col = row == root ? UNASSIGNED : previous;
+        }
+
+        // refresh the tight costs along the new matching
+        for (int col : finalized_) {
+            const int row = col_owner_[col];
+            if (row == UNASSIGNED || row_match_[row] != col) continue;
+            if (col >= cols) {
+                row_match_cost_[row] = max_cost;
+                continue;
+            }
+            for (int k = cost.row_offsets[row]; k < cost.row_offsets[row + 1]; ++k) {
+                if (cost.cols[k] == col) {
+                    row_match_cost_[row] = cost.costs[k];
+                    break;
+                }
+            }
+        }
+
+        for (int col : touched_) {
+            dist_[col] = INF;
+            col_used_[col] = 0;
+        }
+    }
+
+    int assigned = 0;
+    for (int row = 0; row < rows; ++row) {
+        if (row_match_[row] != UNASSIGNED && row_match_[row] < cols) {
+            row_to_col[row] = row_match_[row];
+            assigned++;
+        }
+    }
+    return assigned;
+}
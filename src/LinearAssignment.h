@@ -0,0 +1,55 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+// compressed sparse rows, at most one entry per (row, col): the candidate columns of row i are cols[row_offsets[i] .. row_offsets[i + 1])
+struct SparseCostMatrix {
+    std::vector<int> row_offsets{0};
+    std::vector<int> cols;
+    std::vector<float> costs;
+
+    void clear() {
+        row_offsets.assign(1, 0);
+        cols.clear();
+        costs.clear();
+    }
+    void add(int col, float cost) {
+        cols.push_back(col);
+        costs.push_back(cost);
+    }
+    void endRow() { row_offsets.push_back(static_cast<int>(cols.size())); }
+    int rows() const { return static_cast<int>(row_offsets.size()) - 1; }
+};
+
+// rectangular linear assignment (shortest augmenting path / Jonker-Volgenant style) over a
+// flat row-major cost buffer. every row may also stay unassigned at cost max_cost, so pairs
+// costing max_cost or more are never returned. scratch buffers are reused between calls.
+class LinearAssignment {
+public:
+    static constexpr int UNASSIGNED = -1;
+
+    // fills row_to_col (size rows) and returns the number of assigned rows
+    int solve(const float* cost, int rows, int cols, float max_cost, std::vector<int>& row_to_col);
+
+    // same problem with only the listed pairs allowed; work grows with the number of candidates
+    // instead of rows x cols
+    int solve(const SparseCostMatrix& cost, int cols, float max_cost, std::vector<int>& row_to_col);
+
+private:
+    std::vector<double> row_potential_;
+    std::vector<double> col_potential_;
+    std::vector<double> min_slack_;
+    std::vector<int> col_owner_;
+    std::vector<int> prev_col_;
+    std::vector<char> col_used_;
+
+    // sparse solver state
+    std::vector<double> dist_;
+    std::vector<int> col_pred_;
+    std::vector<int> touched_;
+    std::vector<int> finalized_;
+    std::vector<int> row_match_;
+    std::vector<double> row_match_cost_;
+    std::vector<std::pair<double, int>> heap_;
+};
@@ -0,0 +1,221 @@
+#include "Metrics.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+size_t assignMetricShard() {
+    static std::atomic<size_t> next_shard{0};
+    return next_shard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) total += shard.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+void LatencyHistogram::record(int64_t duration_ns) {
+    size_t bucket = 0;
+    while (bucket < BUCKET_BOUNDS_NS.size() && duration_ns > BUCKET_BOUNDS_NS[bucket]) bucket++;
+
+    Shard& shard = shards_[metricShard()];
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum_ns.fetch_add(duration_ns, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot total;
+    for (const auto& shard : shards_) {
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            total.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+        }
+        total.count += shard.count.load(std::memory_order_relaxed);
+        total.sum_ns += shard.sum_ns.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+std::string metricLabel(const std::string& key, const std::string& value) {
+    std::string label = key + "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') label += '\\';
+        if (c == '\n') {
+            label += "\\n";
+            continue;
+        }
+        label += c;
+    }
+    return label + "\"";
+}
+
+LatencyHistogram& stageHistogram(const std::string& stage) {
+    return MetricsRegistry::instance().histogram("visionary_stage_seconds", "Wall time of one call of a pipeline stage",
+                                                 metricLabel("stage", stage));
+}
+
+static std::atomic<int64_t> process_start_ns{0};
+static std::atomic<bool> first_result_reported{false};
+
+static int64_t steadyNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void markProcessStart() {
+    process_start_ns.store(steadyNanos(), std::memory_order_relaxed);
+    first_result_reported.store(false, std::memory_order_relaxed);
+}
+
+void reportFirstResult() {
+    // one relaxed load per result once reported
+    if (first_result_reported.load(std::memory_order_relaxed)) return;
+    if (first_result_reported.exchange(true)) return;
+
+    const int64_t start_ns = process_start_ns.load(std::memory_order_relaxed);
+    if (start_ns == 0) return;
+    const int64_t elapsed_ms = (steadyNanos() - start_ns) / 1000000;
+    MetricsRegistry::instance()
+        .gauge("visionary_time_to_first_result_milliseconds", "Time from process start to the first tracked frame")
+        .set(elapsed_ms);
+    std::cout << "First result " << elapsed_ms << " ms after start" << std::endl;
+}
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Entry& MetricsRegistry::findOrAdd(const std::string& name, const std::string& help,
+                                                   const std::string& labels, Type type) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : entries_) {
+        if (entry.name != name) continue;
+        if (entry.type != type) throw std::runtime_error("Metric " + name + " registered with two types");
+        if (entry.labels == labels) return entry;
+    }
+
+    Entry& entry = entries_.emplace_back();
+    entry.name = name;
+    entry.help = help;
+    entry.labels = labels;
+    entry.type = type;
+    switch (type) {
+        case Type::Counter: entry.counter = std::make_unique<Counter>(); break;
+        case Type::Gauge: entry.gauge = std::make_unique<Gauge>(); break;
+        case Type::Histogram: entry.histogram = std::make_unique<LatencyHistogram>(); break;
+    }
+    return entry;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    return *findOrAdd(name, help, labels, Type::Counter).counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    return *findOrAdd(name, help, labels, Type::Gauge).gauge;
+}
+
+LatencyHistogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                             const std::string& labels) {
+    return *findOrAdd(name, help, labels, Type::Histogram).histogram;
+}
+
+static std::string withLabels(const std::string& name, const std::string& labels, const std::string& extra = "") {
+    if (labels.empty() && extra.empty()) return name;
+    std::string joined = labels;
+    if (!labels.empty() && !extra.empty()) joined += ",";
+    return name + "{" + joined + extra + "}";
+}
+
+void MetricsRegistry::writePrometheus(std::ostream& out) const {
+    static const char* TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // one HELP/TYPE header per family, followed by all of its label sets
+    std::vector<const std::string*> families;
+    for (const auto& entry : entries_) {
+        bool seen = false;
+        for (const std::string* family : families) seen = seen || *family == entry.name;
+        if (!seen) families.push_back(&entry.name);
+    }
+
+    for (const std::string* family : families) {
+        bool header_written = false;
+        for (const auto& entry : entries_) {
+            if (entry.name != *family) continue;
+            if (!header_written) {
+                out << "# HELP " << entry.name << " " << entry.help << "\n"
+                    << "# TYPE " << entry.name << " " << TYPE_NAMES[static_cast<int>(entry.type)] << "\n";
+                header_written = true;
+            }
+
+            switch (entry.type) {
+                case Type::Counter:
+                    out << withLabels(entry.name, entry.labels) << " " << entry.counter->value() << "\n";
+                    break;
+                case Type::Gauge:
+                    out << withLabels(entry.name, entry.labels) << " " << entry.gauge->value() << "\n";
+                    break;
+                case Type::Histogram: {
+                    const LatencyHistogram::Snapshot snapshot = entry.histogram->snapshot();
+                    uint64_t cumulative = 0;
+                    for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; i++) {
+                        cumulative += snapshot.buckets[i];
+                        const std::string bound = i < LatencyHistogram::BUCKET_BOUNDS_NS.size()
+                            ? std::to_string(LatencyHistogram::BUCKET_BOUNDS_NS[i] / 1e9)
+                            : "+Inf";
+                        out << withLabels(entry.name + "_bucket", entry.labels, metricLabel("le", bound))
+                            << " " << cumulative << "\n";
+                    }
+                    out << withLabels(entry.name + "_sum", entry.labels) << " " << snapshot.sum_ns / 1e9 << "\n"
+                        << withLabels(entry.name + "_count", entry.labels) << " " << snapshot.count << "\n";
+                    break;
+                }
+            }
+        }
+    }
+}
+
+MetricsExporter::MetricsExporter(std::string path, std::chrono::milliseconds interval)
+    : path_(std::move(path))
+    , interval_(interval)
+    , thread_(&MetricsExporter::run, this) {}
+
+MetricsExporter::~MetricsExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    write();
+}
+
+void MetricsExporter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!wake_.wait_for(lock, interval_, [this] { return stopping_; })) {
+        lock.unlock();
+        write();
+        lock.lock();
+    }
+}
+
+void MetricsExporter::write() const {
+    const std::string temp_path = path_ + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Could not write metrics to " << temp_path << std::endl;
+            return;
+        }
+        MetricsRegistry::instance().writePrometheus(out);
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temp_path, path_, error);
+    if (error) std::cerr << "Could not replace " << path_ << ": " << error.message() << std::endl;
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+// process-wide counters, gauges and latency histograms for the hot paths. recording is a relaxed
+// atomic add into a cache-line sized shard picked per thread, so threads never share a line in
+// practice and nothing on the hot path locks; the shards are only summed when exporting.
+// metrics are created once (usually into a function-local static) and live until exit.
+
+constexpr size_t METRIC_SHARDS = 16;
+
+size_t assignMetricShard();
+
+inline size_t metricShard() {
+    thread_local const size_t shard = assignMetricShard();
+    return shard;
+}
+
+class Counter {
+public:
+    void add(uint64_t n = 1) { shards_[metricShard()].value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Shard, METRIC_SHARDS> shards_;
+};
+
+// last value wins, e.g. a queue depth
+class Gauge {
+public:
+    void set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// fixed buckets from 100 us to 1 s, exported in seconds
+class LatencyHistogram {
+public:
+    static constexpr std::array<int64_t, 13> BUCKET_BOUNDS_NS = {
+        100'000, 250'000, 500'000,
+        1'000'000, 2'500'000, 5'000'000,
+        10'000'000, 25'000'000, 50'000'000,
+        100'000'000, 250'000'000, 500'000'000,
+        1'000'000'000
+    };
+    static constexpr size_t BUCKET_COUNT = BUCKET_BOUNDS_NS.size() + 1;    // the last one is +Inf
+
+    void record(int64_t duration_ns);
+    void recordMillis(double duration_ms) { record(static_cast<int64_t>(duration_ms * 1e6)); }
+
+    struct Snapshot {
+        std::array<uint64_t, BUCKET_COUNT> buckets{};     // not cumulative
+        uint64_t count = 0;
+        int64_t sum_ns = 0;
+    };
+    Snapshot snapshot() const;
+
+private:
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets{};
+        std::atomic<uint64_t> count{0};
+        std::atomic<int64_t> sum_ns{0};
+    };
+    std::array<Shard, METRIC_SHARDS> shards_;
+};
+
+// records the lifetime of the scope into a histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(LatencyHistogram& histogram)
+        : histogram_(histogram)
+        , start_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        histogram_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    LatencyHistogram& histogram_;
+    const std::chrono::steady_clock::time_point start_;
+};
+
+// visionary_stage_seconds{stage="..."}, shared by every instrumented pipeline stage
+LatencyHistogram& stageHistogram(const std::string& stage);
+
+// time to first result: main() marks the start, the first result handed to the sinks logs the
+// elapsed time once and exports it as visionary_time_to_first_result_milliseconds
+void markProcessStart();
+void reportFirstResult();
+
+// `key="value"` with the value escaped for the Prometheus text format
+std::string metricLabel(const std::string& key, const std::string& value);
+
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    // the same name and labels return the same metric; labels is a rendered set such as
+    // metricLabel("camera", "0"). registration locks, keep it off the hot path
+    Counter& counter(const std::string& name, const std::string& help, const std::string& labels = "");
+    Gauge& gauge(const std::string& name, const std::string& help, const std::string& labels = "");
+    LatencyHistogram& histogram(const std::string& name, const std::string& help, const std::string& labels = "");
+
+    // Prometheus text exposition format
+    void writePrometheus(std::ostream& out) const;
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Entry {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Type type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<LatencyHistogram> histogram;
+    };
+
+    mutable std::mutex mutex_;
+    std::deque<Entry> entries_;     // in registration order, families stay together on export
+
+    Entry& findOrAdd(const std::string& name, const std::string& help, const std::string& labels, Type type);
+};
+
+// rewrites a Prometheus text file (e.g. for node_exporter's textfile collector) every interval
+// and once more on destruction. the file is replaced atomically, a scraper never sees half of it
+class MetricsExporter {
+public:
+    explicit MetricsExporter(std::string path, std::chrono::milliseconds interval = std::chrono::seconds(5));
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+private:
+    const std::string path_;
+    const std::chrono::milliseconds interval_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+    std::thread thread_;
+
+    void run();
+    void write() const;
+};
@@ -0,0 +1,145 @@
+#include "NonMaxSuppressor.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <cmath>
+
+// IoU of one box against count boxes in SoA form, written to out
+static void iouAgainst(float bx1, float by1, float bx2, float by2, float barea,
+                       const float* x1, const float* y1, const float* x2, const float* y2, const float* area,
+                       size_t count, float* out) {
+    constexpr float MIN_UNION = 1e-6f;
+    size_t j = 0;
+
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+    const size_t lanes = static_cast<size_t>(cv::VTraits<cv::v_float32>::vlanes());
+    const cv::v_float32 v_bx1 = cv::vx_setall_f32(bx1);
+    const cv::v_float32 v_by1 = cv::vx_setall_f32(by1);
+    const cv::v_float32 v_bx2 = cv::vx_setall_f32(bx2);
+    const cv::v_float32 v_by2 = cv::vx_setall_f32(by2);
+    const cv::v_float32 v_barea = cv::vx_setall_f32(barea);
+    const cv::v_float32 v_zero = cv::vx_setzero_f32();
+    const cv::v_float32 v_min_union = cv::vx_setall_f32(MIN_UNION);
+    for (; j + lanes <= count; j += lanes) {
+        cv::v_float32 w = cv::v_max(cv::v_sub(cv::v_min(v_bx2, cv::vx_load(x2 + j)),
+                                              cv::v_max(v_bx1, cv::vx_load(x1 + j))), v_zero);
+        cv::v_float32 h = cv::v_max(cv::v_sub(cv::v_min(v_by2, cv::vx_load(y2 + j)),
+                                              cv::v_max(v_by1, cv::vx_load(y1 + j))), v_zero);
+        cv::v_float32 inter = cv::v_mul(w, h);
+        cv::v_float32 uni = cv::v_sub(cv::v_add(v_barea, cv::vx_load(area + j)), inter);
+        cv::v_store(out + j, cv::v_div(inter, cv::v_max(uni, v_min_union)));
+    }
+#endif
+    for (; j < count; ++j) {
+        float w = std::max(std::min(bx2, x2[j]) - std::max(bx1, x1[j]), 0.0f);
+        float h = std::max(std::min(by2, y2[j]) - std::max(by1, y1[j]), 0.0f);
+        float inter = w * h;
+        out[j] = inter / std::max(barea + area[j] - inter, MIN_UNION);
+    }
+}
+
+NonMaxSuppressor::NonMaxSuppressor(const NmsOptions& options)
+    : options_(options) {}
+
+// gathers the boxes above the score threshold, sorted by descending score (ties by index, so
+// results don't depend on the sort), and shifts each class into its own coordinate range
+void NonMaxSuppressor::load(const DetectionCandidates& boxes) {
+    order_.clear();
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        if (boxes.score[i] > options_.score_threshold) order_.push_back(static_cast<int>(i));
+    }
+    std::sort(order_.begin(), order_.end(), [&](int a, int b) {
+        return boxes.score[a] > boxes.score[b] || (boxes.score[a] == boxes.score[b] && a < b);
+    });
+
+    float min_coord = 0.0f, max_coord = 0.0f;
+    if (options_.class_aware && !order_.empty()) {
+        min_coord = std::min(boxes.x1[order_[0]], boxes.y1[order_[0]]);
+        max_coord = std::max(boxes.x2[order_[0]], boxes.y2[order_[0]]);
+        for (int i : order_) {
+            min_coord = std::min({min_coord, boxes.x1[i], boxes.y1[i]});
+            max_coord = std::max({max_coord, boxes.x2[i], boxes.y2[i]});
+        }
+    }
+    // one empty pixel between neighbouring class ranges, so their boxes can't even touch
+    const float class_span = options_.class_aware ? max_coord - min_coord + 1.0f : 0.0f;
+
+    const size_t count = order_.size();
+    x1_.resize(count);
+    y1_.resize(count);
+    x2_.resize(count);
+    y2_.resize(count);
+    area_.resize(count);
+    score_.resize(count);
+    iou_.resize(count);
+    for (size_t k = 0; k < count; ++k) {
+        const int i = order_[k];
+        const float offset = options_.class_aware ? boxes.class_id[i] * class_span - min_coord : 0.0f;
+        x1_[k] = boxes.x1[i] + offset;
+        y1_[k] = boxes.y1[i] + offset;
+        x2_[k] = boxes.x2[i] + offset;
+        y2_[k] = boxes.y2[i] + offset;
+        area_[k] = std::max(boxes.x2[i] - boxes.x1[i], 0.0f) * std::max(boxes.y2[i] - boxes.y1[i], 0.0f);
+        score_[k] = boxes.score[i];
+    }
+}
+
+void NonMaxSuppressor::moveSlot(size_t from, size_t to) {
+    order_[to] = order_[from];
+    x1_[to] = x1_[from];
+    y1_[to] = y1_[from];
+    x2_[to] = x2_[from];
+    y2_[to] = y2_[from];
+    area_[to] = area_[from];
+    score_[to] = score_[from];
+}
+
+void NonMaxSuppressor::run(const DetectionCandidates& boxes, std::vector<int>& keep, std::vector<float>& kept_scores) {
+    keep.clear();
+    kept_scores.clear();
+    load(boxes);
+
+    const float inverse_sigma = 1.0f / options_.soft_sigma;
+    size_t live = order_.size();    // slots [head, live) are still in play
+    for (size_t head = 0; head < live; ++head) {
+        if (options_.soft) {
+            // decayed scores are out of order, the best remaining box goes to the front
+            size_t best = head;
+            for (size_t j = head + 1; j < live; ++j) {
+                if (score_[j] > score_[best]) best = j;
+            }
+            if (best != head) {
+                std::swap(order_[head], order_[best]);
+                std::swap(x1_[head], x1_[best]);
+                std::swap(y1_[head], y1_[best]);
+                std::swap(x2_[head], x2_[best]);
+                std::swap(y2_[head], y2_[best]);
+                std::swap(area_[head], area_[best]);
+                std::swap(score_[head], score_[best]);
+            }
+        }
+
+        keep.push_back(order_[head]);
+        kept_scores.push_back(score_[head]);
+        if (options_.top_k > 0 && keep.size() >= options_.top_k) break;
+
+        const size_t rest = head + 1;
+        iouAgainst(x1_[head], y1_[head], x2_[head], y2_[head], area_[head],
+                   x1_.data() + rest, y1_.data() + rest, x2_.data() + rest, y2_.data() + rest,
+                   area_.data() + rest, live - rest, iou_.data() + rest);
+
+        // survivors move up, so the next round only touches boxes still in play
+        size_t write = rest;
+        for (size_t j = rest; j < live; ++j) {
+            const float iou = iou_[j];
+            if (options_.soft) {
+                score_[j] *= std::exp(-iou * iou * inverse_sigma);
+                if (score_[j] <= options_.score_threshold) continue;
+            } else if (iou > options_.iou_threshold) {
+                continue;
+            }
+            if (write != j) moveSlot(j, write);
+            write++;
+        }
+        live = write;
+    }
+}
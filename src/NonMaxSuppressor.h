@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "YoloDecoder.h"
+
+struct NmsOptions {
+    float score_threshold = 0.4f;   // boxes must score above this
+    float iou_threshold = 0.4f;
+    bool class_aware = true;        // a box only suppresses boxes of its own class
+    size_t top_k = 300;             // stop once this many boxes are kept, 0 keeps all
+    bool soft = false;              // gaussian soft-NMS: overlaps decay scores instead of removing boxes
+    float soft_sigma = 0.5f;
+};
+
+// greedy NMS over a DetectionCandidates buffer. class-aware suppression moves every class into
+// its own coordinate range (the batched-offset trick), so a single pass handles all classes.
+// the boxes still in play are kept compacted in SoA scratch arrays, and the IoU of the kept box
+// against all of them is computed with OpenCV's universal intrinsics. every kept box shrinks
+// the work of the next. a warmed-up instance doesn't allocate
+class NonMaxSuppressor {
+public:
+    explicit NonMaxSuppressor(const NmsOptions& options = {});
+
+    // indices into boxes of the survivors in the order they were kept (descending score), with
+    // their final scores in kept_scores; soft-NMS lowers those of overlapping boxes
+    void run(const DetectionCandidates& boxes, std::vector<int>& keep, std::vector<float>& kept_scores);
+
+    const NmsOptions& options() const { return options_; }
+    void setOptions(const NmsOptions& options) { options_ = options; }
+
+private:
+    NmsOptions options_;
+
+    // boxes still in play, sorted by score, in offset coordinates
+    std::vector<int> order_;
+    std::vector<float> x1_, y1_, x2_, y2_, area_, score_;
+    std::vector<float> iou_;
+
+    void load(const DetectionCandidates& boxes);
+    void moveSlot(size_t from, size_t to);
+};
@@ -1,4 +1,10 @@
 #include "OCSortTracker.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cmath>
+
+// weight of the newest measurement in the smoothed velocity
+constexpr float VELOCITY_SMOOTHING = 0.5f;
 
 OCSortTracker::OCSortTracker(float delta_t, 
                            int max_age,
@@ -11,28 +17,33 @@ OCSortTracker::OCSortTracker(float delta_t,
     : tracker_(delta_t, max_age, min_hits, iou_threshold, 
               associate_method, distance_metric, inertia, use_byte) {}
 
-std::vector<TrackingResult> OCSortTracker::update(const std::vector<YoloDetector::Detection>& detections) {
-    std::vector<std::vector<float>> detection_data;
-    
-    for (const auto& det : detections) {
-        std::vector<float> row{
-            det.x1, det.y1, det.x2, det.y2,
-            det.confidence,
-            static_cast<float>(det.class_id)
-        };
-        detection_data.push_back(row);
+void OCSortTracker::update(const std::vector<YoloDetector::Detection>& detections,
+                           std::vector<TrackingResult>& out) {
+    static LatencyHistogram& track_time = stageHistogram("track");
+    ScopedTimer timer(track_time);
+
+    const Eigen::Index count = static_cast<Eigen::Index>(detections.size());
+    if (count > detection_matrix_.rows()) {
+        // eigen doesn't keep spare capacity, so grow in steps instead of on every new maximum
+        detection_matrix_.resize(std::max<Eigen::Index>(count, 2 * detection_matrix_.rows()), 6);
     }
 
-    if (detection_data.empty()) {
-        return {};
+    for (Eigen::Index i = 0; i < count; ++i) {
+        const auto& det = detections[i];
+        detection_matrix_(i, 0) = det.x1;
+        detection_matrix_(i, 1) = det.y1;
+        detection_matrix_(i, 2) = det.x2;
+        detection_matrix_(i, 3) = det.y2;
+        detection_matrix_(i, 4) = det.confidence;
+        detection_matrix_(i, 5) = static_cast<float>(det.class_id);
     }
 
-    auto matrix = Vector2Matrix(detection_data);
-    std::vector<Eigen::RowVectorXf> tracking_output = tracker_.update(matrix);
+    // an empty frame still goes through the tracker so tracks coast and age out
+    std::vector<Eigen::RowVectorXf> tracking_output = tracker_.update(detection_matrix_.topRows(count));
 
-    std::vector<TrackingResult> results;
+    out.clear();
     for (const auto& track : tracking_output) {
-        TrackingResult result{
+        out.push_back(TrackingResult{
             track[0],
             track[1],
             track[2],
@@ -40,21 +51,65 @@ std::vector<TrackingResult> OCSortTracker::update(const std::vector<YoloDetector
             static_cast<int>(track[4]),
             static_cast<int>(track[5]),
             track[6]
+        });
+    }
+    updateVelocities(out);
+}
+
+void OCSortTracker::updateVelocities(const std::vector<TrackingResult>& tracks) {
+    // the box moved over all frames since the last update, predicted ones included
+    const float frames = static_cast<float>(predicted_steps_ + 1);
+    next_velocities_.resize(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        const size_t* previous = last_index_.find(tracks[i].track_id);
+        if (!previous) {
+            next_velocities_[i] = BoxVelocity{};
+            continue;
+        }
+
+        const TrackingResult& before = last_tracks_[*previous];
+        const BoxVelocity& old = velocities_[*previous];
+        auto smooth = [&](float now, float then, float old_velocity) {
+            return VELOCITY_SMOOTHING * (now - then) / frames + (1.0f - VELOCITY_SMOOTHING) * old_velocity;
         };
-        results.push_back(result);
+        next_velocities_[i].x1 = smooth(tracks[i].x1, before.x1, old.x1);
+        next_velocities_[i].y1 = smooth(tracks[i].y1, before.y1, old.y1);
+        next_velocities_[i].x2 = smooth(tracks[i].x2, before.x2, old.x2);
+        next_velocities_[i].y2 = smooth(tracks[i].y2, before.y2, old.y2);
     }
+    std::swap(velocities_, next_velocities_);
 
-    return results;
+    last_tracks_.assign(tracks.begin(), tracks.end());
+    last_index_.clear();
+    for (size_t i = 0; i < tracks.size(); ++i) last_index_[tracks[i].track_id] = i;
+    predicted_steps_ = 0;
+    prediction_drift_ = 0.0f;
 }
 
-Eigen::Matrix<float, Eigen::Dynamic, 6> OCSortTracker::Vector2Matrix(const std::vector<std::vector<float>>& data) {
-    if (data.empty()) return Eigen::Matrix<float, Eigen::Dynamic, 6>(0, 6);
-    
-    Eigen::Matrix<float, Eigen::Dynamic, 6> matrix(data.size(), 6);
-    for (size_t i = 0; i < data.size(); ++i) {
-        for (size_t j = 0; j < 6; ++j) {
-            matrix(i, j) = data[i][j];
-        }
+void OCSortTracker::predict(std::vector<TrackingResult>& out) {
+    predicted_steps_++;
+    const float steps = static_cast<float>(predicted_steps_);
+
+    out.clear();
+    prediction_drift_ = 0.0f;
+    for (size_t i = 0; i < last_tracks_.size(); ++i) {
+        const BoxVelocity& velocity = velocities_[i];
+        TrackingResult track = last_tracks_[i];
+        track.x1 += velocity.x1 * steps;
+        track.y1 += velocity.y1 * steps;
+        track.x2 += velocity.x2 * steps;
+        track.y2 += velocity.y2 * steps;
+        out.push_back(track);
+
+        const float center_shift_x = 0.5f * std::abs(velocity.x1 + velocity.x2) * steps;
+        const float center_shift_y = 0.5f * std::abs(velocity.y1 + velocity.y2) * steps;
+        const float box_size = std::max(1.0f, std::min(track.x2 - track.x1, track.y2 - track.y1));
+        prediction_drift_ = std::max(prediction_drift_, std::max(center_shift_x, center_shift_y) / box_size);
     }
-    return matrix;
-}
\ No newline at end of file
+}
+
+std::vector<TrackingResult> OCSortTracker::update(const std::vector<YoloDetector::Detection>& detections) {
+    std::vector<TrackingResult> results;
+    update(detections, results);
+    return results;
+}
@@ -2,6 +2,7 @@
 
 #include <Eigen/Dense>
 #include <vector>
+#include "FlatIdMap.h"
 #include <opencv2/core/mat.hpp>
 #include "YoloDetector.h"
 #include "../../oc-sort/deploy/OCSort/cpp/include/OCSort.hpp"
@@ -24,10 +25,38 @@ public:
                   float inertia = 0.3941737016672115,
                   bool use_byte = true);
 
+    // results replace the contents of out, whose capacity is reused between frames. call this for
+    // every frame, including empty ones, so unmatched tracks age and eventually die
+    void update(const std::vector<YoloDetector::Detection>& detections, std::vector<TrackingResult>& out);
+
     std::vector<TrackingResult> update(const std::vector<YoloDetector::Detection>& detections);
 
+    // for frames the detector skipped: moves the tracks of the last update along their smoothed
+    // velocity without touching the ocsort state, so skipped frames neither age tracks nor break
+    // their hit streaks. to ocsort the frames between two updates look like a single step
+    void predict(std::vector<TrackingResult>& out);
+
+    // how far predict() has carried the fastest track since the last update, in box sizes;
+    // beyond ~0.5 the extrapolation is unlikely to still cover the object
+    float predictionDrift() const { return prediction_drift_; }
+
 private:
+    struct BoxVelocity {
+        float x1 = 0.0f, y1 = 0.0f, x2 = 0.0f, y2 = 0.0f;   // px per frame
+    };
+
     ocsort::OCSort tracker_;
 
-    static Eigen::Matrix<float, Eigen::Dynamic, 6> Vector2Matrix(const std::vector<std::vector<float>>& data);
+    // output of the last update with the velocity of each track, and where each id sits in it
+    std::vector<TrackingResult> last_tracks_;
+    std::vector<BoxVelocity> velocities_;
+    std::vector<BoxVelocity> next_velocities_;
+    FlatIdMap<size_t> last_index_;
+    int predicted_steps_ = 0;
+    float prediction_drift_ = 0.0f;
+
+    void updateVelocities(const std::vector<TrackingResult>& tracks);
+
+    // [x1, y1, x2, y2, conf, class] per row; only grows, the first rows hold the current frame
+    Eigen::Matrix<float, Eigen::Dynamic, 6> detection_matrix_;
 };
\ No newline at end of file
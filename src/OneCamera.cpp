@@ -1,7 +1,14 @@
+#include "OneCamera.h"
 #include "yolodetector.h"
 #include "OCSortTracker.h"
+#include "ResultSink.h"
+#include "RunOptions.h"
+#include "FrameSource.h"
+#include "Metrics.h"
+#include "KeyframeScheduler.h"
 #include <opencv2/opencv.hpp>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <cstdlib>
 #include <sstream>
@@ -91,7 +98,7 @@ cv::Mat visualize_detections_and_tracks(
     const std::vector<YoloDetector::Detection>& detections,
     const std::vector<TrackingResult>& tracks,
     const std::vector<std::string>& classes,
-    const std::map<int, int>* track_to_super_id = nullptr) {
+    const std::vector<int>* super_ids) {
 
     for (const auto& det : detections) {
         cv::Rect box(
@@ -106,7 +113,8 @@ cv::Mat visualize_detections_and_tracks(
         draw_label(input_image, label, box.x, box.y);
     }
 
-    for (const auto& track : tracks) {
+    for (size_t i = 0; i < tracks.size(); i++) {
+        const auto& track = tracks[i];
         cv::Rect track_box(
             static_cast<int>(track.x1),
             static_cast<int>(track.y1),
@@ -117,8 +125,8 @@ cv::Mat visualize_detections_and_tracks(
         cv::rectangle(input_image, track_box, RED, THICKNESS);
 
         std::string track_label;
-        if (track_to_super_id && track_to_super_id->count(track.track_id)) {
-            int super_id = track_to_super_id->at(track.track_id);
+        int super_id = super_ids ? (*super_ids)[i] : -1;
+        if (super_id >= 0) {
             track_label = cv::format("ID:%d (S:%d)", track.track_id, super_id);
         } else {
             track_label = cv::format("ID:%d", track.track_id);
@@ -220,15 +228,18 @@ std::string get_camera_info() {
 }
 
 
-int oneCameraProto() {
+int oneCameraProto(const RunOptions& options) {
 
 
-    disable_logging();
+    // reopening stdout on the terminal would take it away from the results
+    if (!options.resultsOnStdout()) {
+        disable_logging();
 
-     // std::string camera_info = get_camera_info();
-    std::cout << "loading YOLO network... (pre-clear)" << std::endl;
+         // std::string camera_info = get_camera_info();
+        std::cout << "loading YOLO network... (pre-clear)" << std::endl;
 
-    enable_logging();
+        enable_logging();
+    }
      //std::cout << "Found cameras:\n" << camera_info << std::endl;
 
     std::cout << "loading YOLO network... (post-clear)" << std::endl;
@@ -247,48 +258,101 @@ int oneCameraProto() {
         }
 
         std::cout << "loading YOLO network..." << std::endl;
-        YoloDetector detector("assets/yolov9-m.onnx");
-        std::cout << "network loaded successfully" << std::endl;
+        YoloDetector detector("assets/yolov9-m.onnx", 0.4f, 0.4f,
+                              YoloDetector::PreprocessMode::Letterbox, options.inference);
+        std::cout << "network loaded successfully (" << detector.describeBackend() << ")" << std::endl;
 
         OCSortTracker tracker;
         std::cout << "tracker initialized" << std::endl;
 
-        std::cout << "opening camera" << std::endl;
-        cv::VideoCapture cap(2);
-
-
-
-        if (!cap.isOpened()) {
-            std::cerr << "error! -> perm denied" << std::endl;
+        std::string input = "2";
+        if (!options.inputs.empty()) {
+            input = options.inputs.front();
+        } else if (!options.cameras.empty()) {
+            input = std::to_string(options.cameras.front());
+        }
+        FrameSourceOptions source_options;
+        source_options.pacing = options.as_fast_as_possible ? Pacing::AsFastAsPossible : Pacing::RealTime;
+        source_options.width = options.capture_width;
+        source_options.height = options.capture_height;
+        std::unique_ptr<FrameSource> source = FrameSource::create(input, source_options);
+
+        ResultSinks sinks = ResultSinks::fromOptions(options, classes, 1, "YOLO V9 with Tracking");
+
+        // the first forward pass runs while the source opens
+        std::future<double> warm_up = std::async(std::launch::async, [&detector] { return detector.warmUp(); });
+        std::cout << "opening " << source->describe() << std::endl;
+        const bool opened = source->open();
+        warm_up.get();
+        if (!opened) {
+            std::cerr << "error! -> failed to open " << source->describe() << std::endl;
             return -1;
         }
-        std::cout << "camera open success" << std::endl;
-
-        while (true) {
-            cv::Mat frame;
-            cap >> frame;
-            if (frame.empty()) {
-                std::cerr << "! error capturing frame" << std::endl;
+        std::cout << "source open success" << std::endl;
+        installStopHandler();
+
+        const std::string camera_label = metricLabel("camera", source->describe());
+        Counter& frames_captured = MetricsRegistry::instance().counter(
+            "visionary_frames_captured_total", "Frames read from a source", camera_label);
+        LatencyHistogram& capture_time = MetricsRegistry::instance().histogram(
+            "visionary_capture_seconds", "Time one read of a source blocks, including waiting for the frame",
+            camera_label);
+
+        Counter& frames_detected = MetricsRegistry::instance().counter(
+            "visionary_frames_detected_total", "Keyframes that ran through the detector", camera_label);
+        Counter& frames_redetected = MetricsRegistry::instance().counter(
+            "visionary_frames_redetected_total", "Frames between keyframes re-detected in crops around the tracks",
+            camera_label);
+        KeyframeScheduler keyframes(options.keyframes);
+
+        cv::Mat frame;
+        std::vector<YoloDetector::Detection> detections;
+        std::vector<TrackingResult> tracks;
+        std::vector<cv::Rect> regions;
+        uint64_t sequence = 0;
+        while (!stopRequested()) {
+            int64_t capture_ns = 0;
+            bool got_frame;
+            {
+                ScopedTimer timer(capture_time);
+                got_frame = source->read(frame, capture_ns);
+            }
+            if (!got_frame) {
+                // a recording simply ended
+                if (source->isLive()) std::cerr << "! error capturing frame" << std::endl;
                 break;
             }
 
-            auto detections = detector.detect(frame);
-
-            auto tracks = tracker.update(detections);
-
-            cv::Mat img = visualize_detections_and_tracks(frame, detections, tracks, classes);
-
-            cv::imshow("YOLO V9 with Tracking", img);
-
-            if (cv::waitKey(1) == 'q') {
+            frames_captured.add();
+            if (keyframes.isKeyframe(frame)) {
+                detections = detector.detect(frame);
+                frames_detected.add();
+                tracker.update(detections, tracks);
+            } else if (keyframes.regionsOfInterest(frame.size(), regions)) {
+                detections = detector.detectRegions(frame, regions);
+                frames_redetected.add();
+                tracker.update(detections, tracks);
+            } else {
+                detections.clear();
+                tracker.predict(tracks);
+            }
+            keyframes.setTracks(tracks, frame.size(), tracker.predictionDrift());
+
+            FrameResult result;
+            result.camera = options.inputs.empty() ? std::atoi(input.c_str()) : 0;
+            result.sequence = sequence++;
+            result.capture_ns = capture_ns;
+            result.frame = &frame;
+            result.detections = &detections;
+            result.tracks = &tracks;
+            sinks.consume(result);
+
+            if (!sinks.keepRunning()) {
                 std::cout << "quit signal received" << std::endl;
                 break;
             }
         }
 
-        cap.release();
-        cv::destroyAllWindows();
-
         return 0;
     } catch (const std::exception &e) {
         std::cerr << "unexpected error: " << e.what() << std::endl;
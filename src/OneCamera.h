@@ -1,10 +1,15 @@
+#pragma once
+
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <string>
 
+#include "OCSortTracker.h"
 #include "YoloDetector.h"
 
-int oneCameraProto();
+struct RunOptions;
+
+int oneCameraProto(const RunOptions& options);
 
 
 void disable_logging();
@@ -16,6 +21,6 @@ cv::Mat visualize_detections_and_tracks(
     const std::vector<YoloDetector::Detection>& detections,
     const std::vector<TrackingResult>& tracks,
     const std::vector<std::string>& classes,
-    const std::map<int, int>* track_to_super_id = nullptr
+    const std::vector<int>* super_ids = nullptr     // aligned with tracks, -1 if unmatched
 );
 std::string get_camera_info();
\ No newline at end of file
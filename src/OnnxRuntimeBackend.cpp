@@ -0,0 +1,97 @@
+#include "OnnxRuntimeBackend.h"
+#include <stdexcept>
+
+// one environment (logging, global thread pools) for every session in the process
+static Ort::Env& sharedEnv() {
+    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "visionary");
+    return env;
+}
+
+// sessions of the same model share their prepacked (layout-transformed) weights instead of each
+// keeping a copy, which is most of a session's memory and of its creation time
+static Ort::PrepackedWeightsContainer& sharedPrepackedWeights() {
+    static Ort::PrepackedWeightsContainer container;
+    return container;
+}
+
+OnnxRuntimeBackend::OnnxRuntimeBackend(const std::string& model_path, const InferenceOptions& options) {
+    Ort::SessionOptions session_options;
+    session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    session_options.SetExecutionMode(ExecutionMode::ORT_SEQUENTIAL);
+    session_options.SetInterOpNumThreads(1);
+    if (options.threads > 0) session_options.SetIntraOpNumThreads(options.threads);
+    if (!options.thread_affinity.empty()) {
+        // one group per intra-op thread but the first (the caller's), e.g. "1;2;3" for 4 threads
+        session_options.AddConfigEntry("session.intra_op_thread_affinities", options.thread_affinity.c_str());
+    }
+
+    try {
+        const auto bytes = modelBytes(model_path);
+        session_ = Ort::Session(sharedEnv(), bytes->data(), bytes->size(), session_options,
+                                sharedPrepackedWeights());
+    } catch (const Ort::Exception& e) {
+        throw std::runtime_error("Failed to load network: " + std::string(e.what()));
+    }
+    memory_info_ = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+    Ort::AllocatorWithDefaultOptions allocator;
+    for (size_t i = 0; i < session_.GetInputCount(); i++) {
+        input_names_.emplace_back(session_.GetInputNameAllocated(i, allocator).get());
+    }
+    for (size_t i = 0; i < session_.GetOutputCount(); i++) {
+        output_names_.emplace_back(session_.GetOutputNameAllocated(i, allocator).get());
+    }
+    if (input_names_.size() != 1) {
+        throw std::runtime_error("Expected a model with one input, got " + std::to_string(input_names_.size()));
+    }
+    for (const auto& name : input_names_) input_name_ptrs_.push_back(name.c_str());
+    for (const auto& name : output_names_) output_name_ptrs_.push_back(name.c_str());
+
+    const ONNXTensorElementDataType input_type =
+        session_.GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType();
+    if (input_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT && input_type != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+        throw std::runtime_error("Unsupported model input type " + std::to_string(input_type));
+    }
+    half_input_ = input_type == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16;
+    float_outputs_.resize(output_names_.size());
+
+    description_ = std::string("onnxruntime / cpu") + (half_input_ ? " fp16 io" : "") + ", " +
+        (options.threads > 0 ? std::to_string(options.threads) : std::string("default")) + " threads";
+}
+
+void OnnxRuntimeBackend::infer(const cv::Mat& blob, std::vector<cv::Mat>& outputs) {
+    CV_Assert(blob.type() == CV_32F && blob.isContinuous());
+
+    input_shape_.assign(blob.size.p, blob.size.p + blob.dims);
+    Ort::Value input{nullptr};
+    if (half_input_) {
+        blob.convertTo(half_blob_, CV_16F);
+        input = Ort::Value::CreateTensor(memory_info_, half_blob_.data, half_blob_.total() * half_blob_.elemSize(),
+                                         input_shape_.data(), input_shape_.size(),
+                                         ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16);
+    } else {
+        input = Ort::Value::CreateTensor<float>(
+            memory_info_, const_cast<float*>(blob.ptr<float>()), blob.total(),
+            input_shape_.data(), input_shape_.size());
+    }
+
+    output_values_ = session_.Run(Ort::RunOptions{nullptr},
+                                  input_name_ptrs_.data(), &input, 1,
+                                  output_name_ptrs_.data(), output_name_ptrs_.size());
+
+    outputs.resize(output_values_.size());
+    for (size_t i = 0; i < output_values_.size(); i++) {
+        const Ort::TensorTypeAndShapeInfo info = output_values_[i].GetTensorTypeAndShapeInfo();
+        const std::vector<int64_t> shape = info.GetShape();
+        output_sizes_.assign(shape.begin(), shape.end());
+        const int dims = static_cast<int>(output_sizes_.size());
+
+        if (info.GetElementType() == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16) {
+            cv::Mat half(dims, output_sizes_.data(), CV_16F, output_values_[i].GetTensorMutableRawData());
+            half.convertTo(float_outputs_[i], CV_32F);
+            outputs[i] = float_outputs_[i];
+        } else {
+            outputs[i] = cv::Mat(dims, output_sizes_.data(), CV_32F, output_values_[i].GetTensorMutableData<float>());
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <onnxruntime_cxx_api.h>
+#include "InferenceBackend.h"
+
+// ONNX Runtime on its CPU execution provider, only built with -DVISIONARY_ONNXRUNTIME=ON.
+// the input blob is wrapped, not copied, and float outputs point into ONNX Runtime's tensors.
+// INT8 QDQ models keep float inputs and run as they are; models exported with float16 inputs
+// or outputs are converted at the boundary
+class OnnxRuntimeBackend : public InferenceBackend {
+public:
+    OnnxRuntimeBackend(const std::string& model_path, const InferenceOptions& options);
+
+    void infer(const cv::Mat& blob, std::vector<cv::Mat>& outputs) override;
+    std::string describe() const override { return description_; }
+
+private:
+    Ort::Session session_{nullptr};
+    Ort::MemoryInfo memory_info_{nullptr};
+    std::vector<std::string> input_names_;
+    std::vector<std::string> output_names_;
+    std::vector<const char*> input_name_ptrs_;
+    std::vector<const char*> output_name_ptrs_;
+    std::vector<int64_t> input_shape_;
+    std::vector<int> output_sizes_;
+    std::vector<Ort::Value> output_values_;    // backs the Mats handed out by infer()
+    bool half_input_ = false;
+    cv::Mat half_blob_;
+    std::vector<cv::Mat> float_outputs_;        // float16 outputs converted to float32
+    std::string description_;
+};
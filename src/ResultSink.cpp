@@ -0,0 +1,215 @@
+#include "ResultSink.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include "OneCamera.h"
+#include "Metrics.h"
+
+#ifndef VISIONARY_HEADLESS
+#include <opencv2/highgui.hpp>
+#endif
+
+JsonLinesSink::JsonLinesSink(const std::string& path)
+    : out_(stdout)
+    , owns_file_(false) {
+    if (path != "-") {
+        out_ = std::fopen(path.c_str(), "w");
+        if (!out_) {
+            throw std::runtime_error("Failed to open results file " + path);
+        }
+        owns_file_ = true;
+    }
+}
+
+JsonLinesSink::~JsonLinesSink() {
+    if (owns_file_) {
+        std::fclose(out_);
+    } else {
+        std::fflush(out_);
+    }
+}
+
+void JsonLinesSink::append(const char* format, ...) {
+    char buffer[256];
+    va_list args, retry;
+    va_start(args, format);
+    va_copy(retry, args);
+    const int written = std::vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (written > 0 && static_cast<size_t>(written) < sizeof(buffer)) {
+        line_.append(buffer, static_cast<size_t>(written));
+    } else if (written > 0) {
+        // too long for the stack buffer, format again straight into the line
+        const size_t start = line_.size();
+        line_.resize(start + static_cast<size_t>(written) + 1);
+        std::vsnprintf(line_.data() + start, static_cast<size_t>(written) + 1, format, retry);
+        line_.resize(start + static_cast<size_t>(written));
+    }
+    va_end(retry);
+}
+
+// JSON has no nan or inf
+void JsonLinesSink::appendNumber(float value, int precision) {
+    if (std::isfinite(value)) {
+        append("%.*f", precision, value);
+    } else {
+        line_ += "null";
+    }
+}
+
+void JsonLinesSink::appendArray(std::initializer_list<float> values, int precision) {
+    line_ += '[';
+    for (const float* value = values.begin(); value != values.end(); ++value) {
+        if (value != values.begin()) line_ += ',';
+        appendNumber(*value, precision);
+    }
+    line_ += ']';
+}
+
+void JsonLinesSink::consume(const FrameResult& result) {
+    // the line buffer keeps its capacity, so steady state formatting doesn't allocate
+    line_.clear();
+    append("{\"camera\":%d,\"sequence\":%llu,\"capture_ns\":%lld", result.camera,
+           static_cast<unsigned long long>(result.sequence), static_cast<long long>(result.capture_ns));
+
+    line_ += ",\"detections\":[";
+    if (result.detections) {
+        for (size_t i = 0; i < result.detections->size(); i++) {
+            const auto& det = (*result.detections)[i];
+            append("%s{\"class\":%d,\"conf\":", i ? "," : "", det.class_id);
+            appendNumber(det.confidence, 3);
+            line_ += ",\"box\":";
+            appendArray({det.x1, det.y1, det.x2, det.y2}, 1);
+            line_ += '}';
+        }
+    }
+
+    line_ += "],\"tracks\":[";
+    if (result.tracks) {
+        for (size_t i = 0; i < result.tracks->size(); i++) {
+            const auto& track = (*result.tracks)[i];
+            const int super_id = result.super_ids ? (*result.super_ids)[i] : -1;
+            append("%s{\"id\":%d,\"super_id\":%d,\"class\":%d,\"conf\":",
+                   i ? "," : "", track.track_id, super_id, track.class_id);
+            appendNumber(track.confidence, 3);
+            line_ += ",\"box\":";
+            appendArray({track.x1, track.y1, track.x2, track.y2}, 1);
+            line_ += '}';
+        }
+    }
+
+    line_ += "],\"objects\":[";
+    if (result.objects) {
+        for (size_t i = 0; i < result.objects->size(); i++) {
+            const auto& object = (*result.objects)[i];
+            append("%s{\"super_id\":%d,\"class\":%d,\"position\":", i ? "," : "", object.super_id, object.class_id);
+            appendArray({object.position.x, object.position.y, object.position.z}, 3);
+            line_ += ",\"velocity\":";
+            appendArray({object.velocity.x, object.velocity.y, object.velocity.z}, 3);
+            line_ += '}';
+        }
+    }
+    line_ += "]}\n";
+
+    std::fwrite(line_.data(), 1, line_.size(), out_);
+}
+
+#ifndef VISIONARY_HEADLESS
+DisplaySink::DisplaySink(std::string window_name, std::vector<std::string> classes,
+                         size_t camera_count, int sample_every)
+    : window_name_(std::move(window_name))
+    , classes_(std::move(classes))
+    , SAMPLE_EVERY(static_cast<uint64_t>(std::max(1, sample_every)))
+    , frame_counts_(camera_count, 0) {
+    const int cols = static_cast<int>(std::min<size_t>(camera_count, GRID_COLS));
+    const int rows = static_cast<int>((camera_count + GRID_COLS - 1) / GRID_COLS);
+    canvas_ = cv::Mat::zeros(rows * CELL_HEIGHT, cols * CELL_WIDTH, CV_8UC3);
+
+    cv::namedWindow(window_name_, cv::WINDOW_NORMAL);
+    cv::resizeWindow(window_name_, canvas_.cols, canvas_.rows);
+}
+
+DisplaySink::~DisplaySink() {
+    cv::destroyWindow(window_name_);
+}
+
+void DisplaySink::consume(const FrameResult& result) {
+    if (result.slot >= frame_counts_.size() || !result.frame || result.frame->empty()) return;
+    if (frame_counts_[result.slot]++ % SAMPLE_EVERY != 0) return;
+
+    // the pipeline may still hand this frame to other sinks, draw on a copy
+    result.frame->copyTo(scratch_);
+    static const std::vector<YoloDetector::Detection> no_detections;
+    static const std::vector<TrackingResult> no_tracks;
+    const auto& tracks = result.tracks ? *result.tracks : no_tracks;
+    visualize_detections_and_tracks(scratch_,
+                                    result.detections ? *result.detections : no_detections,
+                                    tracks, classes_, result.super_ids);
+
+    if (result.objects) {
+        for (const auto& object : *result.objects) {
+            for (const auto& track : tracks) {
+                if (track.track_id != object.left_id) continue;
+                cv::putText(scratch_, cv::format("Z:%.2f", object.position.z),
+                           cv::Point(track.x1, track.y2 + 15),
+                           cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 255), 1, cv::LINE_AA);
+                break;
+            }
+        }
+    }
+
+    cv::putText(scratch_, std::to_string(result.camera), cv::Point(10, 30),
+               cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(0, 255, 0), 2);
+
+    const int slot = static_cast<int>(result.slot);
+    cv::Mat cell = canvas_(cv::Rect((slot % GRID_COLS) * CELL_WIDTH, (slot / GRID_COLS) * CELL_HEIGHT,
+                                    CELL_WIDTH, CELL_HEIGHT));
+    if (scratch_.size() == cell.size()) {
+        scratch_.copyTo(cell);
+    } else {
+        cv::resize(scratch_, cell, cell.size());
+    }
+    dirty_ = true;
+}
+
+bool DisplaySink::keepRunning() {
+    if (dirty_) {
+        cv::imshow(window_name_, canvas_);
+        dirty_ = false;
+    }
+    return cv::waitKey(1) != 'q';
+}
+#endif
+
+ResultSinks ResultSinks::fromOptions(const RunOptions& options, const std::vector<std::string>& classes,
+                                     size_t camera_count, const std::string& window_name) {
+    ResultSinks sinks;
+    if (!options.results_path.empty()) {
+        sinks.add(std::make_unique<JsonLinesSink>(options.results_path));
+    }
+#ifndef VISIONARY_HEADLESS
+    if (!options.headless) {
+        sinks.add(std::make_unique<DisplaySink>(window_name, classes, camera_count, options.display_every));
+    }
+#else
+    (void)classes;
+    (void)camera_count;
+    (void)window_name;
+#endif
+    return sinks;
+}
+
+void ResultSinks::consume(const FrameResult& result) {
+    reportFirstResult();
+    for (auto& sink : sinks_) sink->consume(result);
+}
+
+bool ResultSinks::keepRunning() {
+    bool keep_running = true;
+    for (auto& sink : sinks_) keep_running = sink->keepRunning() && keep_running;
+    return keep_running;
+}
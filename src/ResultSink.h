@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "OCSortTracker.h"
+#include "RunOptions.h"
+#include "StereoTriangulator.h"
+#include "YoloDetector.h"
+
+// one processed frame of one camera; everything is borrowed and only valid inside consume()
+struct FrameResult {
+    size_t slot = 0;                                        // camera position within this run
+    int camera = -1;                                        // device index
+    uint64_t sequence = 0;
+    int64_t capture_ns = 0;
+    const cv::Mat* frame = nullptr;
+    const std::vector<YoloDetector::Detection>* detections = nullptr;
+    const std::vector<TrackingResult>* tracks = nullptr;
+    const std::vector<int>* super_ids = nullptr;            // aligned with tracks, -1 if unmatched
+    const std::vector<StereoObject>* objects = nullptr;     // objects whose left track is in this frame
+};
+
+// subscribers of the processing loop. consume() runs on the loop's thread, so sinks must be
+// cheap or sample; the loop itself never draws
+class ResultSink {
+public:
+    virtual ~ResultSink() = default;
+    virtual void consume(const FrameResult& result) = 0;
+
+    // called once per loop iteration, false asks the loop to stop
+    virtual bool keepRunning() { return true; }
+};
+
+// one JSON object per frame and line; numbers that aren't finite (a lost depth) are written as null
+class JsonLinesSink : public ResultSink {
+public:
+    // "-" writes to stdout, which then carries nothing else (see reserveStdoutForResults())
+    explicit JsonLinesSink(const std::string& path);
+    ~JsonLinesSink() override;
+
+    JsonLinesSink(const JsonLinesSink&) = delete;
+    JsonLinesSink& operator=(const JsonLinesSink&) = delete;
+
+    void consume(const FrameResult& result) override;
+
+private:
+    std::FILE* out_;
+    bool owns_file_;
+    std::string line_;
+
+    void append(const char* format, ...);
+    void appendNumber(float value, int precision);
+    void appendArray(std::initializer_list<float> values, int precision);
+};
+
+#ifndef VISIONARY_HEADLESS
+// draws every Nth frame of each camera into a grid and shows it; drawing happens on a copy
+class DisplaySink : public ResultSink {
+public:
+    DisplaySink(std::string window_name, std::vector<std::string> classes,
+                size_t camera_count, int sample_every = 1);
+    ~DisplaySink() override;
+
+    void consume(const FrameResult& result) override;
+    bool keepRunning() override;
+
+private:
+    const std::string window_name_;
+    const std::vector<std::string> classes_;
+    const uint64_t SAMPLE_EVERY;
+    std::vector<uint64_t> frame_counts_;
+    cv::Mat canvas_;
+    cv::Mat scratch_;
+    bool dirty_ = false;
+
+    static constexpr int GRID_COLS = 3;
+    static constexpr int CELL_WIDTH = 640;
+    static constexpr int CELL_HEIGHT = 480;
+};
+#endif
+
+// fans results out to every configured sink
+class ResultSinks {
+public:
+    // JSON output when requested, and the display unless running headless
+    static ResultSinks fromOptions(const RunOptions& options, const std::vector<std::string>& classes,
+                                   size_t camera_count, const std::string& window_name);
+
+    void add(std::unique_ptr<ResultSink> sink) { sinks_.push_back(std::move(sink)); }
+    bool empty() const { return sinks_.empty(); }
+
+    void consume(const FrameResult& result);
+    bool keepRunning();
+
+private:
+    std::vector<std::unique_ptr<ResultSink>> sinks_;
+};
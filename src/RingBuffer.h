@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+enum class OverflowPolicy {
+    DropOldest,   // producer evicts the oldest queued item, capture never stalls
+    Block         // producer waits for the consumer
+};
+
+// bounded lock-free ring between one producer and one consumer thread. slots carry a
+// sequence number (Vyukov-style) so the producer can also evict from the consumer end
+// when the policy is DropOldest without racing the consumer on the same slot.
+template<typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity, OverflowPolicy policy = OverflowPolicy::DropOldest)
+        : capacity_(roundUpPow2(capacity))
+        , mask_(capacity_ - 1)
+        , policy_(policy)
+        , slots_(new Slot[capacity_]) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // producer side; returns false only if stop was raised while blocked
+    bool push(T&& item, const std::atomic<bool>& stop) {
+        int attempt = 0;
+        while (!tryPush(item)) {
+            if (policy_ == OverflowPolicy::DropOldest && size() >= capacity_) {
+                T discarded;
+                if (tryPop(discarded)) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+            }
+            if (stop.load(std::memory_order_relaxed)) return false;
+            backoff(attempt++);
+        }
+        return true;
+    }
+
+    bool tryPush(T& item) {
+        const size_t pos = head_.load(std::memory_order_relaxed);
+        Slot& slot = slots_[pos & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != pos) return false;
+
+        slot.value = std::move(item);
+        slot.sequence.store(pos + 1, std::memory_order_release);
+        head_.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side; returns false once stop is raised and the ring is empty, so a producer
+    // can raise stop right after its last push without that item getting lost
+    bool pop(T& out, const std::atomic<bool>& stop) {
+        int attempt = 0;
+        while (!tryPop(out)) {
+            if (stop.load(std::memory_order_acquire)) return tryPop(out);
+            backoff(attempt++);
+        }
+        return true;
+    }
+
+    bool tryPop(T& out) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[pos & mask_];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+
+            if (diff < 0) return false;
+            if (diff > 0) {
+                pos = tail_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                out = std::move(slot.value);
+                slot.sequence.store(pos + capacity_, std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    size_t size() const {
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return head >= tail ? head - tail : 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundUpPow2(size_t n) {
+        size_t pow2 = 1;
+        while (pow2 < n) pow2 <<= 1;
+        return pow2;
+    }
+
+    static void backoff(int attempt) {
+        if (attempt < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    const size_t capacity_;
+    const size_t mask_;
+    const OverflowPolicy policy_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    std::atomic<uint64_t> dropped_{0};
+};
@@ -0,0 +1,152 @@
+#include "RunOptions.h"
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+static std::string requireValue(int argc, char** argv, int& i) {
+    if (i + 1 >= argc) {
+        throw std::runtime_error(std::string("Missing value for ") + argv[i]);
+    }
+    return argv[++i];
+}
+
+static int parseInt(const std::string& value, const std::string& option) {
+    try {
+        size_t used = 0;
+        int result = std::stoi(value, &used);
+        if (used == value.size()) return result;
+    } catch (const std::exception&) {}
+    throw std::runtime_error("Invalid number '" + value + "' for " + option);
+}
+
+static float parseFloat(const std::string& value, const std::string& option) {
+    try {
+        size_t used = 0;
+        float result = std::stof(value, &used);
+        if (used == value.size()) return result;
+    } catch (const std::exception&) {}
+    throw std::runtime_error("Invalid number '" + value + "' for " + option);
+}
+
+RunOptions RunOptions::parse(int argc, char** argv) {
+    RunOptions options;
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg == "--multi") {
+            options.mode = Mode::Multi;
+        } else if (arg == "--single") {
+            options.mode = Mode::Single;
+        } else if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--display-every") {
+            options.display_every = parseInt(requireValue(argc, argv, i), arg);
+            if (options.display_every < 1) throw std::runtime_error("--display-every must be at least 1");
+        } else if (arg == "--results") {
+            options.results_path = requireValue(argc, argv, i);
+        } else if (arg == "--cameras") {
+            std::stringstream list(requireValue(argc, argv, i));
+            std::string index;
+            while (std::getline(list, index, ',')) {
+                options.cameras.push_back(parseInt(index, arg));
+            }
+        } else if (arg == "--inputs") {
+            std::stringstream list(requireValue(argc, argv, i));
+            std::string input;
+            while (std::getline(list, input, ',')) {
+                if (!input.empty()) options.inputs.push_back(input);
+            }
+        } else if (arg == "--fast") {
+            options.as_fast_as_possible = true;
+        } else if (arg == "--metrics") {
+            options.metrics_path = requireValue(argc, argv, i);
+        } else if (arg == "--engine") {
+            options.inference.engine = InferenceBackend::parseEngine(requireValue(argc, argv, i));
+        } else if (arg == "--threads") {
+            options.inference.threads = parseInt(requireValue(argc, argv, i), arg);
+            if (options.inference.threads < 0) throw std::runtime_error("--threads can't be negative");
+        } else if (arg == "--detectors") {
+            const int detectors = parseInt(requireValue(argc, argv, i), arg);
+            if (detectors < 1) throw std::runtime_error("--detectors must be at least 1");
+            options.detectors = static_cast<size_t>(detectors);
+        } else if (arg == "--affinity") {
+            options.inference.thread_affinity = requireValue(argc, argv, i);
+        } else if (arg == "--resolution") {
+            const std::string value = requireValue(argc, argv, i);
+            const size_t x = value.find('x');
+            if (x == std::string::npos) throw std::runtime_error("--resolution must look like 3840x2160");
+            options.capture_width = parseInt(value.substr(0, x), arg);
+            options.capture_height = parseInt(value.substr(x + 1), arg);
+            if (options.capture_width < 1 || options.capture_height < 1) {
+                throw std::runtime_error("--resolution must be positive");
+            }
+        } else if (arg == "--keyframe-interval") {
+            options.keyframes.max_interval = parseInt(requireValue(argc, argv, i), arg);
+            if (options.keyframes.max_interval < 1) throw std::runtime_error("--keyframe-interval must be at least 1");
+            options.keyframes.enabled = options.keyframes.max_interval > 1;
+        } else if (arg == "--keyframe-motion") {
+            options.keyframes.new_object_motion = parseFloat(requireValue(argc, argv, i), arg);
+            // a share of the thumbnail's pixels; written this way, nan fails too
+            if (!(options.keyframes.new_object_motion >= 0.0f && options.keyframes.new_object_motion <= 1.0f)) {
+                throw std::runtime_error("--keyframe-motion must be between 0 and 1");
+            }
+        } else if (arg == "--roi-redetect") {
+            options.keyframes.roi_redetect = true;
+        } else if (arg == "--tiled") {
+            options.inference.tiling.enabled = true;
+        } else if (arg == "--tile-size") {
+            options.inference.tiling.tile_size = parseInt(requireValue(argc, argv, i), arg);
+        } else if (arg == "--tile-overlap") {
+            options.inference.tiling.overlap = parseInt(requireValue(argc, argv, i), arg);
+        } else {
+            throw std::runtime_error("Unknown argument " + arg);
+        }
+    }
+
+    if (options.keyframes.roi_redetect && !options.keyframes.enabled) {
+        throw std::runtime_error("--roi-redetect needs a --keyframe-interval above 1");
+    }
+
+    const TilingOptions& tiling = options.inference.tiling;
+    if (tiling.tile_size < 32) throw std::runtime_error("--tile-size must be at least 32");
+    if (tiling.overlap < 0 || tiling.overlap >= tiling.tile_size) {
+        throw std::runtime_error("--tile-overlap must be between 0 and the tile size");
+    }
+
+#ifdef VISIONARY_HEADLESS
+    options.headless = true;
+#endif
+    return options;
+}
+
+const char* RunOptions::usage() {
+    return "usage: detection [--multi | --single] [--cameras 0,1,... | --inputs <video|dir>,...] [--fast]\n"
+           "                 [--headless] [--display-every N] [--results <file.jsonl> | --results -]\n"
+           "                 [--metrics <file.prom>] [--detectors N]\n"
+           "                 [--engine opencv|openvino|onnxruntime] [--threads N] [--affinity <cores>]\n"
+           "                 [--resolution WxH] [--tiled] [--tile-size N] [--tile-overlap N]\n"
+           "                 [--keyframe-interval N] [--keyframe-motion <share>] [--roi-redetect]\n"
+           "with --results -, stdout carries only the results and every message goes to stderr\n"
+           "--multi matches tracks only within stereo rigs (cameras 0-1, 2-3, ...)\n";
+}
+
+void reserveStdoutForResults() {
+    std::cout.flush();
+    std::cout.rdbuf(std::cerr.rdbuf());
+}
+
+static std::atomic<bool> stop_requested{false};
+
+static void onStopSignal(int) {
+    stop_requested.store(true);
+}
+
+void installStopHandler() {
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+}
+
+bool stopRequested() {
+    return stop_requested.load();
+}
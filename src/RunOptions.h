@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "InferenceBackend.h"
+#include "KeyframeScheduler.h"
+
+// command line of the detection executable
+struct RunOptions {
+    enum class Mode { Stereo, Multi, Single };
+
+    Mode mode = Mode::Stereo;
+    bool headless = false;          // no window, no drawing; results only go to the sinks
+    int display_every = 1;          // the display samples every Nth frame of each camera
+    std::string results_path;       // JSON lines, "-" for stdout, empty for none
+    std::vector<int> cameras;       // device indices, skips the interactive camera picker
+    std::vector<std::string> inputs;    // video files, image directories or camera indices
+    bool as_fast_as_possible = false;   // recorded inputs ignore their frame rate
+    int capture_width = 640;        // requested from live cameras
+    int capture_height = 480;
+    std::string metrics_path;       // Prometheus text file rewritten every few seconds, empty for none
+    InferenceOptions inference;     // engine, threads and tiling of every detector
+    size_t detectors = 0;           // --multi detector pool size, 0 sizes it from the cores
+    KeyframeOptions keyframes;      // which frames run the detector, the tracker predicts the rest
+
+    // throws std::runtime_error on malformed arguments
+    static RunOptions parse(int argc, char** argv);
+    static const char* usage();
+
+    bool resultsOnStdout() const { return results_path == "-"; }
+};
+
+// with --results -, stdout carries nothing but the JSON lines: std::cout, and with it every
+// status and timing message, goes to stderr from here on. call before anything is printed
+void reserveStdoutForResults();
+
+// SIGINT/SIGTERM ask the processing loops to finish, the only way to stop a headless run
+void installStopHandler();
+bool stopRequested();
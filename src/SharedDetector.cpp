@@ -0,0 +1,123 @@
+#include "SharedDetector.h"
+#include <algorithm>
+#include <iostream>
+
+SharedDetector::SharedDetector(std::shared_ptr<YoloDetector> detector,
+                               size_t max_batch,
+                               std::chrono::microseconds batch_window)
+    : detector_(std::move(detector))
+    , max_batch_(std::max<size_t>(1, max_batch))
+    , batch_window_(batch_window)
+    , worker_(&SharedDetector::run, this) {}
+
+SharedDetector::~SharedDetector() {
+    stop();
+}
+
+void SharedDetector::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+std::future<std::vector<YoloDetector::Detection>> SharedDetector::submit(const cv::Mat& frame,
+                                                                         const std::vector<cv::Rect>& regions) {
+    Request request;
+    request.frame = frame;
+    request.regions = regions;
+    auto future = request.result.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            request.result.set_value({});
+            return future;
+        }
+        queue_.push_back(std::move(request));
+    }
+    cv_.notify_one();
+    return future;
+}
+
+std::vector<YoloDetector::Detection> SharedDetector::detect(const cv::Mat& frame,
+                                                            const std::vector<cv::Rect>& regions) {
+    return submit(frame, regions).get();
+}
+
+void SharedDetector::run() {
+    std::vector<Request> batch;
+    std::vector<cv::Mat> frames;
+    batch.reserve(max_batch_);
+    frames.reserve(max_batch_);
+
+    // requests arriving meanwhile queue up; a failure here shows up again on the first frame
+    try {
+        detector_->warmUp();
+    } catch (const std::exception& e) {
+        std::cerr << "Warm-up pass failed: " << e.what() << std::endl;
+    }
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_ && queue_.empty()) break;
+
+            // give the other cameras a short window to join the batch
+            auto deadline = std::chrono::steady_clock::now() + batch_window_;
+            cv_.wait_until(lock, deadline, [this] {
+                return stopping_ || queue_.size() >= max_batch_;
+            });
+
+            while (!queue_.empty() && batch.size() < max_batch_) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+
+        process(batch, frames);
+        batch.clear();
+        frames.clear();
+    }
+}
+
+void SharedDetector::process(std::vector<Request>& batch, std::vector<cv::Mat>& frames) {
+    try {
+        // region requests batch their own mosaics and don't mix with whole frames
+        const bool whole_frames = std::all_of(batch.begin(), batch.end(),
+                                              [](const Request& request) { return request.regions.empty(); });
+        if (batch.size() > 1 && batching_supported_ && whole_frames) {
+            for (const auto& request : batch) frames.push_back(request.frame);
+            try {
+                auto results = detector_->detectBatch(frames);
+                for (size_t i = 0; i < batch.size(); ++i) {
+                    batch[i].result.set_value(std::move(results[i]));
+                }
+                return;
+            } catch (const std::exception& e) {
+                // static-batch exports reject N > 1 (cv::Exception from OpenCV DNN, Ort::Exception
+                // from ONNX Runtime), keep serving them one frame at a time
+                std::cerr << "Batched inference unavailable, falling back to batch size 1: "
+                          << e.what() << std::endl;
+                batching_supported_ = false;
+            }
+        }
+
+        for (auto& request : batch) {
+            request.result.set_value(request.regions.empty()
+                                     ? detector_->detect(request.frame)
+                                     : detector_->detectRegions(request.frame, request.regions));
+        }
+    } catch (...) {
+        for (auto& request : batch) {
+            try {
+                request.result.set_exception(std::current_exception());
+            } catch (const std::future_error&) {
+                // already fulfilled before the failure
+            }
+        }
+    }
+}
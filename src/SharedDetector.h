@@ -0,0 +1,55 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "YoloDetector.h"
+
+// one detector shared by several camera threads: requests are queued and the worker
+// runs whatever arrived within the batching window as a single detectBatch call. the worker
+// starts with a warm-up pass, which overlaps with the cameras opening
+class SharedDetector {
+public:
+    explicit SharedDetector(std::shared_ptr<YoloDetector> detector,
+                            size_t max_batch = 2,
+                            std::chrono::microseconds batch_window = std::chrono::milliseconds(4));
+    ~SharedDetector();
+
+    SharedDetector(const SharedDetector&) = delete;
+    SharedDetector& operator=(const SharedDetector&) = delete;
+
+    // the frame is referenced, not copied - keep it untouched until the future is ready.
+    // with regions, only those parts of the frame are searched (YoloDetector::detectRegions)
+    std::future<std::vector<YoloDetector::Detection>> submit(const cv::Mat& frame,
+                                                             const std::vector<cv::Rect>& regions = {});
+
+    std::vector<YoloDetector::Detection> detect(const cv::Mat& frame, const std::vector<cv::Rect>& regions = {});
+
+    void stop();
+
+private:
+    struct Request {
+        cv::Mat frame;
+        std::vector<cv::Rect> regions;
+        std::promise<std::vector<YoloDetector::Detection>> result;
+    };
+
+    std::shared_ptr<YoloDetector> detector_;
+    const size_t max_batch_;
+    const std::chrono::microseconds batch_window_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request> queue_;
+    bool stopping_ = false;
+    bool batching_supported_ = true;
+    std::thread worker_;
+
+    void run();
+    void process(std::vector<Request>& batch, std::vector<cv::Mat>& frames);
+};
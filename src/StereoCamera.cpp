@@ -10,6 +10,20 @@
 #include <fcntl.h>
 #include "OneCamera.h"
 #include "StereoMatcher.h"
+#include "SharedDetector.h"
+#include "CameraPipeline.h"
+#include "FramePool.h"
+#include "StereoSynchronizer.h"
+#include "StereoRectifier.h"
+#include "StereoTriangulator.h"
+#include "SuperIdRegistry.h"
+#include "TrackingService.h"
+#include "ResultSink.h"
+#include "RunOptions.h"
+#include "FrameSource.h"
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
 
 
 static std::streambuf* original_cout = nullptr;
@@ -40,8 +54,10 @@ static std::streambuf* original_cerr = nullptr;
 #include <condition_variable>
 #include <atomic>
 
+#ifndef VISIONARY_HEADLESS
 struct CameraBuffer {
-    cv::Mat frame;
+    FramePool pool{4, cv::Size(640, 480)};
+    FrameHandle frame;
     std::mutex mutex;
     bool has_new_frame = false;
     std::atomic<bool> stop{false};
@@ -77,10 +93,10 @@ std::vector<int> showCameraGrid() {
     for(size_t i = 0; i < caps.size(); i++) {
         capture_threads.emplace_back([&caps, &buffers, i]() {
             while(!buffers[i]->stop) {
-                cv::Mat new_frame;
-                if(caps[i].read(new_frame) && !new_frame.empty()) {
+                FrameHandle new_frame = buffers[i]->pool.acquire();
+                if(new_frame && caps[i].read(new_frame.mat()) && !new_frame.mat().empty()) {
                     std::lock_guard<std::mutex> lock(buffers[i]->mutex);
-                    new_frame.copyTo(buffers[i]->frame);
+                    buffers[i]->frame = std::move(new_frame);
                     buffers[i]->has_new_frame = true;
                 }
                 std::this_thread::sleep_for(std::chrono::milliseconds(15));
@@ -91,60 +107,45 @@ std::vector<int> showCameraGrid() {
     cv::namedWindow("Cameras Overview - Press Any Key to Continue", cv::WINDOW_NORMAL);
 
     const int grid_cols = 3;
-    std::vector<cv::Mat> display_frames(caps.size());
+    const cv::Size cell_size(640, 480);
+    const int grid_rows = static_cast<int>((caps.size() + grid_cols - 1) / grid_cols);
+    cv::Mat grid = cv::Mat::zeros(grid_rows * cell_size.height, grid_cols * cell_size.width, CV_8UC3);
+    std::vector<FrameHandle> display_frames(caps.size());
     bool first_frame = true;
 
     while(true) {
         bool any_new_frames = false;
 
-        // update frames
+        // take over the newest frames and blit them into their grid cell
         for(size_t i = 0; i < buffers.size(); i++) {
-            std::lock_guard<std::mutex> lock(buffers[i]->mutex);
-            if(buffers[i]->has_new_frame) {
-                buffers[i]->frame.copyTo(display_frames[i]);
-                cv::putText(display_frames[i], std::to_string(valid_indices[i]),
-                           cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX,
-                           1.0, cv::Scalar(0, 255, 0), 2);
+            {
+                std::lock_guard<std::mutex> lock(buffers[i]->mutex);
+                if(!buffers[i]->has_new_frame) continue;
+                display_frames[i] = std::move(buffers[i]->frame);
                 buffers[i]->has_new_frame = false;
-                any_new_frames = true;
             }
+
+            cv::Mat& frame = display_frames[i].mat();
+            cv::putText(frame, std::to_string(valid_indices[i]),
+                       cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX,
+                       1.0, cv::Scalar(0, 255, 0), 2);
+
+            cv::Rect cell(static_cast<int>(i % grid_cols) * cell_size.width,
+                          static_cast<int>(i / grid_cols) * cell_size.height,
+                          cell_size.width, cell_size.height);
+            if(frame.size() == cell_size) {
+                frame.copyTo(grid(cell));
+            } else {
+                cv::Mat cell_view = grid(cell);
+                cv::resize(frame, cell_view, cell_size);
+            }
+            any_new_frames = true;
         }
 
         // update only for first frames / new frames
         if(any_new_frames || first_frame) {
-            std::vector<cv::Mat> grid_rows;
-            std::vector<cv::Mat> current_row;
-
-            for(const auto& frame : display_frames) {
-                if(!frame.empty()) {
-                    current_row.push_back(frame);
-                } else {
-                    current_row.push_back(cv::Mat::zeros(480, 640, CV_8UC3));
-                }
-
-                if(current_row.size() == grid_cols) {
-                    cv::Mat row;
-                    cv::hconcat(current_row, row);
-                    grid_rows.push_back(row);
-                    current_row.clear();
-                }
-            }
-
-            if(!current_row.empty()) {
-                while(current_row.size() < grid_cols) {
-                    current_row.push_back(cv::Mat::zeros(480, 640, CV_8UC3));
-                }
-                cv::Mat row;
-                cv::hconcat(current_row, row);
-                grid_rows.push_back(row);
-            }
-
-            if(!grid_rows.empty()) {
-                cv::Mat grid;
-                cv::vconcat(grid_rows, grid);
-                cv::imshow("Cameras", grid);
-                first_frame = false;
-            }
+            cv::imshow("Cameras", grid);
+            first_frame = false;
         }
 
         int key = cv::waitKey(1);
@@ -168,151 +169,300 @@ std::vector<int> showCameraGrid() {
     cv::destroyAllWindows();
     return valid_indices;
 }
+#endif
 
-struct CameraProcessor {
-    cv::Mat frame;
-    std::vector<YoloDetector::Detection> detections;
-    std::vector<TrackingResult> tracks;
-    std::mutex mutex;
-    std::atomic<bool> has_new_frame{false};
-    std::atomic<bool> stop{false};
-};
-
-int stereoCameraProto() {
-    std::vector<int> available_cams = showCameraGrid();
-    if(available_cams.empty()) {
-        std::cout << "No cameras found!" << std::endl;
-        return -1;
-    }
-
-    int left_idx, right_idx;
-    std::cout << "\nAvailable cameras: ";
-    for(int cam : available_cams) std::cout << cam << " ";
-    std::cout << "\nEnter left camera index: ";
-    std::cin >> left_idx;
-    std::cout << "Enter right camera index: ";
-    std::cin >> right_idx;
+static const char* STEREO_CALIBRATION_PATH = "assets/stereo_calibration.yml";
 
+static std::vector<std::string> loadClasses() {
     std::vector<std::string> classes;
     std::ifstream ifs("assets/coco.names");
     std::string line;
     while(getline(ifs, line)) classes.push_back(line);
+    return classes;
+}
 
-    auto left_detector = std::make_shared<YoloDetector>("assets/yolov9-m.onnx");
-    auto right_detector = std::make_shared<YoloDetector>("assets/yolov9-m.onnx");
-    auto left_processor = std::make_shared<CameraProcessor>();
-    auto right_processor = std::make_shared<CameraProcessor>();
-
-    OCSortTracker left_tracker, right_tracker;
-
-    auto process_camera = [](int camera_idx,
-                           std::shared_ptr<CameraProcessor> processor,
-                           std::shared_ptr<YoloDetector> detector,
-                           OCSortTracker& tracker) {
-        cv::VideoCapture cap(camera_idx);
-        if (!cap.isOpened()) {
-            std::cerr << "Failed to open camera " << camera_idx << std::endl;
-            return;
+// camera indices, or recordings given with --inputs
+static bool pickStereoInputs(const RunOptions& options, std::string& left_input, std::string& right_input) {
+    if(options.inputs.size() >= 2) {
+        left_input = options.inputs[0];
+        right_input = options.inputs[1];
+        return true;
+    }
+    if(options.cameras.size() >= 2) {
+        left_input = std::to_string(options.cameras[0]);
+        right_input = std::to_string(options.cameras[1]);
+        return true;
+    }
+#ifndef VISIONARY_HEADLESS
+    if(!options.headless) {
+        std::vector<int> available_cams = showCameraGrid();
+        if(available_cams.empty()) {
+            std::cout << "No cameras found!" << std::endl;
+            return false;
         }
-        cap.set(cv::CAP_PROP_FRAME_WIDTH, 640);
-        cap.set(cv::CAP_PROP_FRAME_HEIGHT, 640);
-        cap.set(cv::CAP_PROP_BUFFERSIZE, 1);
-        cap.set(cv::CAP_PROP_FPS, 30);
-
-        cv::Mat frame;
-        while(!processor->stop) {
-            if(cap.read(frame) && !frame.empty()) {
-                auto detections = detector->detect(frame);
-                auto tracks = tracker.update(detections);
-
-                std::lock_guard<std::mutex> lock(processor->mutex);
-                frame.copyTo(processor->frame);
-                processor->detections = detections;
-                processor->tracks = tracks;
-                processor->has_new_frame = true;
+
+        int left_idx, right_idx;
+        std::cout << "\nAvailable cameras: ";
+        for(int cam : available_cams) std::cout << cam << " ";
+        std::cout << "\nEnter left camera index: ";
+        std::cin >> left_idx;
+        std::cout << "Enter right camera index: ";
+        std::cin >> right_idx;
+        left_input = std::to_string(left_idx);
+        right_input = std::to_string(right_idx);
+        return true;
+    }
+#endif
+    std::cerr << "Headless stereo needs --cameras <left>,<right> or --inputs <left>,<right>" << std::endl;
+    return false;
+}
+
+// device index for live inputs, the position in the run for recordings
+static int cameraNumber(const std::string& input, int slot) {
+    const bool is_index = !input.empty() &&
+        std::all_of(input.begin(), input.end(), [](unsigned char c) { return std::isdigit(c); });
+    return is_index ? std::stoi(input) : slot;
+}
+
+static FrameSourceOptions sourceOptions(const RunOptions& options) {
+    FrameSourceOptions source_options;
+    source_options.pacing = options.as_fast_as_possible ? Pacing::AsFastAsPossible : Pacing::RealTime;
+    source_options.width = options.capture_width;
+    source_options.height = options.capture_height;
+    return source_options;
+}
+
+int stereoCameraProto(const RunOptions& options) {
+    std::string left_input, right_input;
+    if(!pickStereoInputs(options, left_input, right_input)) return -1;
+    const int left_idx = cameraNumber(left_input, 0);
+    const int right_idx = cameraNumber(right_input, 1);
+
+    std::vector<std::string> classes = loadClasses();
+    ResultSinks sinks = ResultSinks::fromOptions(options, classes, 2, "Stereo Tracking - [Q] to quit");
+    installStopHandler();
+
+    std::unique_ptr<FrameSource> left_source = FrameSource::create(left_input, sourceOptions(options));
+    std::unique_ptr<FrameSource> right_source = FrameSource::create(right_input, sourceOptions(options));
+    if(!left_source->isLive() && !right_source->isLive()) {
+        // two recordings are read in lockstep, so every frame finds its partner
+        StereoFileSource recording(std::move(left_source), std::move(right_source));
+        left_source = recording.left();
+        right_source = recording.right();
+    }
+
+    // one set of weights for both cameras, frames arriving together are inferred as one batch
+    auto detector = std::make_shared<SharedDetector>(
+        std::make_shared<YoloDetector>("assets/yolov9-m.onnx", 0.4f, 0.4f,
+                                       YoloDetector::PreprocessMode::Letterbox, options.inference), 2);
+
+    PipelineConfig pipeline_config;
+    pipeline_config.capture_width = options.capture_width;
+    pipeline_config.capture_height = options.capture_height;
+    pipeline_config.keyframes = options.keyframes;
+    CameraPipeline left_pipeline(std::move(left_source), detector, pipeline_config);
+    CameraPipeline right_pipeline(std::move(right_source), detector, pipeline_config);
+
+    // only captures from the same moment reach inference, both sides share the pair id. the left
+    // scheduler decides keyframes for the pair, so both sides detect or predict the same frames
+    StereoSynchronizer synchronizer(std::chrono::milliseconds(15), 4,
+        [&](CapturedFrame&& left, CapturedFrame&& right) {
+            left.keyframe = right.keyframe = left_pipeline.decideKeyframe(left.frame.mat(), right_pipeline);
+            left_pipeline.submit(std::move(left));
+            right_pipeline.submit(std::move(right));
+        });
+    left_pipeline.setCaptureSink([&](CapturedFrame&& frame) {
+        synchronizer.push(StereoSynchronizer::Side::Left, std::move(frame));
+    });
+    right_pipeline.setCaptureSink([&](CapturedFrame&& frame) {
+        synchronizer.push(StereoSynchronizer::Side::Right, std::move(frame));
+    });
+
+    left_pipeline.start();
+    right_pipeline.start();
+
+    CameraPipeline::Output left_output, right_output;
+    StereoMatcher stereo_matcher(static_cast<float>(options.capture_width));
+
+    // with a calibration, tracks are matched in the rectified frame where rows line up
+    std::unique_ptr<StereoRectifier> rectifier;
+    if (std::filesystem::exists(STEREO_CALIBRATION_PATH)) {
+        try {
+            rectifier = std::make_unique<StereoRectifier>(
+                StereoCalibration::load(STEREO_CALIBRATION_PATH,
+                                        cv::Size(options.capture_width, options.capture_height)));
+            EpipolarBand band;
+            band.max_disparity = static_cast<float>(options.capture_width);
+            stereo_matcher.setEpipolarBand(band);
+            std::cout << "Loaded stereo calibration from " << STEREO_CALIBRATION_PATH << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Ignoring stereo calibration: " << e.what() << std::endl;
+        }
+    }
+    std::vector<TrackingResult> left_rectified, right_rectified;
+    StereoTriangulator triangulator(rectifier.get());
+
+    // ids of tracks that left both trackers are evicted, so this stays bounded on long runs
+    SuperIdRegistry super_ids;
+    std::vector<int> left_super_ids, right_super_ids;
+
+    bool left_ready = false, right_ready = false;
+
+    while(!stopRequested()) {
+        if(!left_ready) left_ready = left_pipeline.fetchLatest(left_output);
+        if(!right_ready) right_ready = right_pipeline.fetchLatest(right_output);
+
+        // a side that lags behind (its half of a pair was dropped downstream) waits for the next
+        if(left_ready && right_ready && left_output.sequence != right_output.sequence) {
+            if(left_output.sequence < right_output.sequence) left_ready = false;
+            else right_ready = false;
+        }
+
+        const bool processed = left_ready && right_ready;
+        if(processed) {
+            left_ready = right_ready = false;
+
+            const std::vector<TrackingResult>* left_tracks = &left_output.tracks;
+            const std::vector<TrackingResult>* right_tracks = &right_output.tracks;
+            if (rectifier) {
+                left_rectified = left_output.tracks;
+                right_rectified = right_output.tracks;
+                rectifier->rectify(StereoRectifier::Side::Left, left_rectified);
+                rectifier->rectify(StereoRectifier::Side::Right, right_rectified);
+                left_tracks = &left_rectified;
+                right_tracks = &right_rectified;
+            }
+
+            auto stereo_pairs = stereo_matcher.matchTracks(*left_tracks, *right_tracks);
+
+            super_ids.beginFrame(left_output.tracks, right_output.tracks);
+            super_ids.assign(stereo_pairs);
+
+            auto objects = triangulator.update(stereo_pairs, *left_tracks, *right_tracks,
+                                               super_ids, left_output.capture_ns);
+
+            left_super_ids.resize(left_output.tracks.size());
+            for(size_t i = 0; i < left_output.tracks.size(); i++) {
+                left_super_ids[i] = super_ids.superId(SuperIdRegistry::Side::Left, left_output.tracks[i].track_id);
             }
-            else {
-                std::cerr << "Camera " << camera_idx << " read error!" << std::endl;
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            right_super_ids.resize(right_output.tracks.size());
+            for(size_t i = 0; i < right_output.tracks.size(); i++) {
+                right_super_ids[i] = super_ids.superId(SuperIdRegistry::Side::Right, right_output.tracks[i].track_id);
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            FrameResult left_result;
+            left_result.slot = 0;
+            left_result.camera = left_idx;
+            left_result.sequence = left_output.sequence;
+            left_result.capture_ns = left_output.capture_ns;
+            left_result.frame = left_output.frame ? &left_output.frame.mat() : nullptr;
+            left_result.detections = &left_output.detections;
+            left_result.tracks = &left_output.tracks;
+            left_result.super_ids = &left_super_ids;
+            left_result.objects = &objects;
+            sinks.consume(left_result);
+
+            FrameResult right_result;
+            right_result.slot = 1;
+            right_result.camera = right_idx;
+            right_result.sequence = right_output.sequence;
+            right_result.capture_ns = right_output.capture_ns;
+            right_result.frame = right_output.frame ? &right_output.frame.mat() : nullptr;
+            right_result.detections = &right_output.detections;
+            right_result.tracks = &right_output.tracks;
+            right_result.super_ids = &right_super_ids;
+            sinks.consume(right_result);
         }
-        cap.release();
-    };
 
-    std::thread left_thread(process_camera, left_idx, left_processor, left_detector, std::ref(left_tracker));
-    std::thread right_thread(process_camera, right_idx, right_processor, right_detector, std::ref(right_tracker));
+        if(!sinks.keepRunning()) break;
 
-    cv::namedWindow("Stereo Tracking - [Q] to quit", cv::WINDOW_NORMAL);
-    cv::resizeWindow("Stereo Tracking - [Q] to quit", 2560, 960);
+        // recordings: once neither side captures anymore, no pair can reach inference
+        if(left_pipeline.captureEnded() && right_pipeline.captureEnded()) {
+            left_pipeline.closeInput();
+            right_pipeline.closeInput();
+        }
+        if(left_pipeline.finished() && right_pipeline.finished()) break;
 
-    cv::Mat display_left, display_right;
-    StereoMatcher stereo_matcher(640.0f);
+        if(!processed) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
 
-    std::map<int, int> left_super_ids;
-    std::map<int, int> right_super_ids;
-    int next_super_id = 0;
+    left_pipeline.stop();
+    right_pipeline.stop();
+    detector->stop();
 
-    while(true) {
-        bool new_left = false, new_right = false;
-
-        if(left_processor->has_new_frame && right_processor->has_new_frame) {
-            std::lock_guard<std::mutex> lock_left(left_processor->mutex);
-            std::lock_guard<std::mutex> lock_right(right_processor->mutex);
-
-            auto stereo_pairs = stereo_matcher.matchTracks(
-                left_processor->tracks,
-                right_processor->tracks
-            );
-
-            for (const auto& pair : stereo_pairs) {
-                int super_id;
-                if (left_super_ids.count(pair.left_id)) {
-                    super_id = left_super_ids[pair.left_id];
-                } else if (right_super_ids.count(pair.right_id)) {
-                    super_id = right_super_ids[pair.right_id];
-                } else {
-                    super_id = next_super_id++;
-                }
+    auto sync_stats = synchronizer.stats();
+    std::cout << "Stereo sync: " << sync_stats.pairs << " pairs, skew mean "
+              << sync_stats.mean_skew_ms << " ms / max " << sync_stats.max_skew_ms
+              << " ms, unpaired left " << sync_stats.dropped_left
+              << " / right " << sync_stats.dropped_right << std::endl;
 
-                left_super_ids[pair.left_id] = super_id;
-                right_super_ids[pair.right_id] = super_id;
-            }
+    return 0;
+}
+
+int multiCameraProto(const RunOptions& options) {
+    std::vector<std::string> inputs = options.inputs;
+    std::vector<int> cameras = options.cameras;
+#ifndef VISIONARY_HEADLESS
+    if(inputs.empty() && cameras.empty() && !options.headless) cameras = showCameraGrid();
+#endif
+    if(inputs.empty()) {
+        for(int camera : cameras) inputs.push_back(std::to_string(camera));
+    }
+    if(inputs.empty()) {
+        std::cout << (options.headless ? "Headless runs need --cameras or --inputs" : "No cameras found!") << std::endl;
+        return -1;
+    }
 
-            left_processor->frame.copyTo(display_left);
-            visualize_detections_and_tracks(display_left,
-                                         left_processor->detections,
-                                         left_processor->tracks,
-                                         classes,
-                                         &left_super_ids);
-            left_processor->has_new_frame = false;
-            new_left = true;
-
-            right_processor->frame.copyTo(display_right);
-            visualize_detections_and_tracks(display_right,
-                                          right_processor->detections,
-                                          right_processor->tracks,
-                                          classes,
-                                          &right_super_ids);
-            right_processor->has_new_frame = false;
-            new_right = true;
-
-            if(!display_left.empty() && !display_right.empty()) {
-                cv::Mat combined;
-                cv::hconcat(display_left, display_right, combined);
-                cv::imshow("Stereo Tracking - [Q] to quit", combined);
+    std::vector<std::string> classes = loadClasses();
+
+    TrackingServiceConfig config;
+    config.sources = inputs;
+    config.pacing = sourceOptions(options).pacing;
+    config.inference = options.inference;
+    config.detector_count = options.detectors;
+    config.pipeline.capture_width = options.capture_width;
+    config.pipeline.capture_height = options.capture_height;
+    config.pipeline.keyframes = options.keyframes;
+    config.image_width = static_cast<float>(options.capture_width);
+
+    ResultSinks sinks = ResultSinks::fromOptions(options, classes, inputs.size(),
+                                                 "Multi-Camera Tracking - [Q] to quit");
+    installStopHandler();
+
+    TrackingService service(config);
+    service.start();
+
+    TrackingSnapshot snapshot;
+
+    while(!stopRequested()) {
+        const bool processed = service.poll(snapshot);
+        if(processed) {
+            for(size_t c = 0; c < snapshot.cameras.size(); c++) {
+                if(!snapshot.updated[c]) continue;
+                auto& output = snapshot.cameras[c];
+
+                FrameResult result;
+                result.slot = c;
+                result.camera = cameraNumber(inputs[c], static_cast<int>(c));
+                result.sequence = output.sequence;
+                result.capture_ns = output.capture_ns;
+                result.frame = output.frame ? &output.frame.mat() : nullptr;
+                result.detections = &output.detections;
+                result.tracks = &output.tracks;
+                result.super_ids = &snapshot.global_ids[c];
+                sinks.consume(result);
             }
         }
 
-        if(cv::waitKey(1) == 'q') break;
+        if(!sinks.keepRunning() || service.finished()) break;
+        if(!processed) std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 
-    left_processor->stop = true;
-    right_processor->stop = true;
-
-    left_thread.join();
-    right_thread.join();
+    service.stop();
+    for(size_t c = 0; c < service.cameraCount(); c++) {
+        std::cout << inputs[c] << ": " << service.droppedFrames(c)
+                  << " dropped frames" << std::endl;
+    }
 
-    cv::destroyAllWindows();
     return 0;
-}
\ No newline at end of file
+}
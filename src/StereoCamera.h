@@ -1 +1,4 @@
-int stereoCameraProto();
+struct RunOptions;
+
+int stereoCameraProto(const RunOptions& options);
+int multiCameraProto(const RunOptions& options);
@@ -1,116 +1,222 @@
 #include "StereoMatcher.h"
+#include "Metrics.h"
+#include <opencv2/core/hal/intrin.hpp>
 #include <algorithm>
 
-StereoMatcher::StereoMatcher(float image_width)
-    : img_width(image_width) {}
+// guards the relative size term against degenerate zero-area boxes
+static constexpr float MIN_AREA = 1e-6f;
+
+StereoMatcher::StereoMatcher(float image_width, MatchStrategy strategy)
+    : img_width(image_width)
+    , match_strategy(strategy) {}
+
+void StereoMatcher::TrackColumns::assign(const std::vector<TrackingResult>& tracks) {
+    const size_t count = tracks.size();
+    cx.resize(count);
+    cy.resize(count);
+    area.resize(count);
+    class_id.resize(count);
+
+    for (size_t i = 0; i < count; i++) {
+        cv::Point2f center = computeBoxCenter(tracks[i]);
+        cx[i] = center.x;
+        cy[i] = center.y;
+        area[i] = computeBoxArea(tracks[i]);
+        class_id[i] = static_cast<float>(tracks[i].class_id);
+    }
+}
 
-std::vector<std::vector<int>> StereoMatcher::computeCostMatrix(
+void StereoMatcher::computeCostMatrix(
     const std::vector<TrackingResult>& left_tracks,
     const std::vector<TrackingResult>& right_tracks
 ) {
-    const size_t left_count = left_tracks.size();
-    const size_t right_count = right_tracks.size();
+    left_columns.assign(left_tracks);
+    right_columns.assign(right_tracks);
+
+    const int left_count = static_cast<int>(left_tracks.size());
+    const int right_count = static_cast<int>(right_tracks.size());
+    cost_matrix.resize(static_cast<size_t>(left_count) * right_count);
+
+    for (int i = 0; i < left_count; i++) {
+        float* row = cost_matrix.data() + static_cast<size_t>(i) * right_count;
+        int j = 0;
+
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+        const float* right_cx = right_columns.cx.data();
+        const float* right_cy = right_columns.cy.data();
+        const float* right_area = right_columns.area.data();
+        const float* right_class = right_columns.class_id.data();
+
+        const int lanes = cv::VTraits<cv::v_float32>::vlanes();
+        const cv::v_float32 v_lx = cv::vx_setall_f32(left_columns.cx[i]);
+        const cv::v_float32 v_ly = cv::vx_setall_f32(left_columns.cy[i]);
+        const cv::v_float32 v_la = cv::vx_setall_f32(left_columns.area[i]);
+        const cv::v_float32 v_lc = cv::vx_setall_f32(left_columns.class_id[i]);
+        const cv::v_float32 v_zero = cv::vx_setzero_f32();
+        const cv::v_float32 v_min_area = cv::vx_setall_f32(MIN_AREA);
+        const cv::v_float32 v_vertical = cv::vx_setall_f32(VERTICAL_WEIGHT);
+        const cv::v_float32 v_horizontal = cv::vx_setall_f32(HORIZONTAL_WEIGHT);
+        const cv::v_float32 v_negative = cv::vx_setall_f32(NEGATIVE_DISP_PENALTY);
+        const cv::v_float32 v_size = cv::vx_setall_f32(SIZE_WEIGHT);
+        const cv::v_float32 v_mismatch = cv::vx_setall_f32(CLASS_MISMATCH_PENALTY);
+
+        for (; j <= right_count - lanes; j += lanes) {
+            cv::v_float32 rx = cv::vx_load(right_cx + j);
+            cv::v_float32 ry = cv::vx_load(right_cy + j);
+            cv::v_float32 ra = cv::vx_load(right_area + j);
+            cv::v_float32 rc = cv::vx_load(right_class + j);
+
+            cv::v_float32 cost = cv::v_mul(v_vertical, cv::v_abs(cv::v_sub(ry, v_ly)));
+
+            cv::v_float32 disparity = cv::v_sub(v_lx, rx);
+            cost = cv::v_fma(v_horizontal, cv::v_max(disparity, v_zero), cost);
+            cost = cv::v_fma(v_negative, cv::v_max(cv::v_sub(v_zero, disparity), v_zero), cost);
+
+            cv::v_float32 area_diff = cv::v_div(cv::v_abs(cv::v_sub(ra, v_la)),
+                                                cv::v_max(cv::v_max(ra, v_la), v_min_area));
+            cost = cv::v_fma(v_size, area_diff, cost);
+
+            cv::v_float32 mismatch = cv::v_ne(rc, v_lc);
+            cost = cv::v_add(cost, cv::v_and(mismatch, v_mismatch));
+
+            cv::v_store(row + j, cost);
+        }
+#endif
+        for (; j < right_count; j++) {
+            row[j] = pairCost(i, j);
+        }
+    }
+}
 
-    std::vector<std::vector<int>> cost_matrix(left_count,
-                                             std::vector<int>(right_count, 0));
+float StereoMatcher::pairCost(int left, int right) const {
+    float cost = VERTICAL_WEIGHT * std::abs(right_columns.cy[right] - left_columns.cy[left]);
 
-    for (size_t i = 0; i < left_count; i++) {
-        const auto& left_track = left_tracks[i];
-        cv::Point2f left_center = computeBoxCenter(left_track);
-        float left_area = computeBoxArea(left_track);
+    // x_left - x_right: a point in front of the rig appears further left in the right camera
+    float disparity = left_columns.cx[left] - right_columns.cx[right];
+    if (disparity < 0) {
+        cost += NEGATIVE_DISP_PENALTY * -disparity;
+    } else {
+        cost += HORIZONTAL_WEIGHT * disparity;
+    }
 
-        for (size_t j = 0; j < right_count; j++) {
-            const auto& right_track = right_tracks[j];
-            cv::Point2f right_center = computeBoxCenter(right_track);
-            float right_area = computeBoxArea(right_track);
+    const float left_area = left_columns.area[left];
+    const float right_area = right_columns.area[right];
+    cost += SIZE_WEIGHT * std::abs(right_area - left_area) /
+            std::max(std::max(right_area, left_area), MIN_AREA);
 
-            float cost = 0.0f;
+    if (right_columns.class_id[right] != left_columns.class_id[left]) {
+        cost += CLASS_MISMATCH_PENALTY;
+    }
 
-            float vert_diff = std::abs(right_center.y - left_center.y);
-            cost += VERTICAL_WEIGHT * vert_diff;
+    return cost;
+}
 
-            float horiz_diff = right_center.x - left_center.x;
-            if (horiz_diff < 0) {
-                cost += NEGATIVE_DISP_PENALTY * std::abs(horiz_diff);
-            } else {
-                cost += HORIZONTAL_WEIGHT * horiz_diff;
-            }
+void StereoMatcher::computeSparseCosts(
+    const std::vector<TrackingResult>& left_tracks,
+    const std::vector<TrackingResult>& right_tracks
+) {
+    left_columns.assign(left_tracks);
+    right_columns.assign(right_tracks);
+
+    const EpipolarBand& band = *epipolar_band;
+    right_index.build(right_columns.cx.data(), right_columns.cy.data(),
+                      static_cast<int>(right_tracks.size()), band.max_vertical_offset);
+
+    sparse_costs.clear();
+    for (int i = 0; i < static_cast<int>(left_tracks.size()); i++) {
+        right_index.query(left_columns.cx[i], left_columns.cy[i], band, [&](int j) {
+            float cost = pairCost(i, j);
+            if (cost < CLASS_MISMATCH_PENALTY) sparse_costs.add(j, cost);
+        });
+        sparse_costs.endRow();
+    }
+}
 
-            float area_diff = std::abs(right_area - left_area) /
-                            std::max(right_area, left_area);
-            cost += SIZE_WEIGHT * area_diff;
+// cheapest-first over all pairs below the gate; same result as repeatedly scanning for the
+// minimum, but O(n^2 log n) instead of O(n^3)
+void StereoMatcher::greedyMatch(int left_count, int right_count) {
+    // stable, so ties resolve in row-major order like the scanning version
+    std::stable_sort(candidate_pairs.begin(), candidate_pairs.end(),
+                     [](const CandidatePair& a, const CandidatePair& b) { return a.cost < b.cost; });
 
-            if (left_track.class_id != right_track.class_id) {
-                cost += CLASS_MISMATCH_PENALTY;
-            }
+    row_to_col.assign(left_count, LinearAssignment::UNASSIGNED);
+    right_matched.assign(right_count, 0);
 
-            cost_matrix[i][j] = static_cast<int>(cost * 100.0f);
-        }
+    for (const auto& candidate : candidate_pairs) {
+        if (row_to_col[candidate.left] != LinearAssignment::UNASSIGNED ||
+            right_matched[candidate.right]) continue;
+
+        row_to_col[candidate.left] = candidate.right;
+        right_matched[candidate.right] = 1;
     }
+}
 
-    return cost_matrix;
+void StereoMatcher::optimalMatch(int left_count, int right_count) {
+    // same gate as the greedy matcher: a class mismatch alone rules a pair out
+    if (epipolar_band) {
+        assignment.solve(sparse_costs, right_count, CLASS_MISMATCH_PENALTY, row_to_col);
+    } else {
+        assignment.solve(cost_matrix.data(), left_count, right_count, CLASS_MISMATCH_PENALTY, row_to_col);
+    }
 }
 
-std::vector<StereoPair> StereoMatcher::greedyMatch(
-    const std::vector<std::vector<int>>& cost_matrix,
+std::vector<StereoPair> StereoMatcher::matchTracks(
     const std::vector<TrackingResult>& left_tracks,
     const std::vector<TrackingResult>& right_tracks
 ) {
-    std::vector<StereoPair> matches;
-    if (cost_matrix.empty()) return matches;
+    static LatencyHistogram& match_time = stageHistogram("stereo_match");
+    ScopedTimer timer(match_time);
 
-    std::vector<bool> left_matched(left_tracks.size(), false);
-    std::vector<bool> right_matched(right_tracks.size(), false);
-
-    while (true) {
-        int min_cost = static_cast<int>(CLASS_MISMATCH_PENALTY * 100.0f);
-        int best_left = -1;
-        int best_right = -1;
+    if (left_tracks.empty() || right_tracks.empty()) {
+        return std::vector<StereoPair>();
+    }
 
-        for (size_t i = 0; i < left_tracks.size(); i++) {
-            if (left_matched[i]) continue;
+    const int left_count = static_cast<int>(left_tracks.size());
+    const int right_count = static_cast<int>(right_tracks.size());
 
-            for (size_t j = 0; j < right_tracks.size(); j++) {
-                if (right_matched[j]) continue;
+    if (epipolar_band) {
+        computeSparseCosts(left_tracks, right_tracks);
+    } else {
+        computeCostMatrix(left_tracks, right_tracks);
+    }
 
-                if (cost_matrix[i][j] < min_cost) {
-                    min_cost = cost_matrix[i][j];
-                    best_left = i;
-                    best_right = j;
+    if (match_strategy == MatchStrategy::Greedy) {
+        candidate_pairs.clear();
+        if (epipolar_band) {
+            for (int i = 0; i < left_count; i++) {
+                for (int k = sparse_costs.row_offsets[i]; k < sparse_costs.row_offsets[i + 1]; k++) {
+                    candidate_pairs.push_back({sparse_costs.costs[k], i, sparse_costs.cols[k]});
+                }
+            }
+        } else {
+            for (int i = 0; i < left_count; i++) {
+                const float* row = cost_matrix.data() + static_cast<size_t>(i) * right_count;
+                for (int j = 0; j < right_count; j++) {
+                    if (row[j] < CLASS_MISMATCH_PENALTY) {
+                        candidate_pairs.push_back({row[j], i, j});
+                    }
                 }
             }
         }
+        greedyMatch(left_count, right_count);
+    } else {
+        optimalMatch(left_count, right_count);
+    }
 
-        if (best_left == -1 || best_right == -1) break;
+    std::vector<StereoPair> matches;
+    for (int i = 0; i < left_count; i++) {
+        if (row_to_col[i] == LinearAssignment::UNASSIGNED) continue;
 
         StereoPair pair;
-        pair.left_id = left_tracks[best_left].track_id;
-        pair.right_id = right_tracks[best_right].track_id;
+        pair.left_id = left_tracks[i].track_id;
+        pair.right_id = right_tracks[row_to_col[i]].track_id;
         matches.push_back(pair);
-
-        left_matched[best_left] = true;
-        right_matched[best_right] = true;
     }
 
     return matches;
 }
 
 
-std::vector<StereoPair> StereoMatcher::matchTracks(
-    const std::vector<TrackingResult>& left_tracks,
-    const std::vector<TrackingResult>& right_tracks
-) {
-    if (left_tracks.empty() || right_tracks.empty()) {
-        return std::vector<StereoPair>();
-    }
-
-     auto cost_matrix = computeCostMatrix(left_tracks, right_tracks);
-    return greedyMatch(cost_matrix, left_tracks, right_tracks);
-
-    /* hungarian instead of (not really suitable) greedy match -- todo @ elia */
-}
-
-
 float StereoMatcher::computeBoxArea(const TrackingResult& track) {
     float width = track.x2 - track.x1;
     float height = track.y2 - track.y1;
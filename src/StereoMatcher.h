@@ -1,26 +1,68 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <cstdint>
 #include <vector>
 #include <list>
+#include <optional>
+#include "EpipolarIndex.h"
 #include "OCSortTracker.h"
+#include "LinearAssignment.h"
 
 struct StereoPair {
     int left_id;
     int right_id;
 };
 
+enum class MatchStrategy {
+    Greedy,     // repeatedly take the cheapest remaining pair
+    Optimal     // minimum total cost assignment (LinearAssignment)
+};
+
 class StereoMatcher {
 public:
-    explicit StereoMatcher(float image_width = 640.0f);
+    explicit StereoMatcher(float image_width = 640.0f,
+                           MatchStrategy strategy = MatchStrategy::Optimal);
 
     std::vector<StereoPair> matchTracks(
         const std::vector<TrackingResult>& left_tracks,
         const std::vector<TrackingResult>& right_tracks
     );
 
+    // only score right tracks inside a vertical band / disparity window of each left track;
+    // the cost structure becomes sparse and matching near-linear for crowded scenes
+    void setEpipolarBand(const EpipolarBand& band) { epipolar_band = band; }
+    void clearEpipolarBand() { epipolar_band.reset(); }
+
 private:
+    // per-camera track geometry, converted once per frame (structure-of-arrays)
+    struct TrackColumns {
+        std::vector<float> cx, cy, area, class_id;
+
+        void assign(const std::vector<TrackingResult>& tracks);
+    };
+
+    struct CandidatePair {
+        float cost;
+        int left;
+        int right;
+    };
+
     float img_width;
+    MatchStrategy match_strategy;
+
+    TrackColumns left_columns;
+    TrackColumns right_columns;
+    std::vector<float> cost_matrix;     // row-major, left x right, reused between frames
+    std::vector<CandidatePair> candidate_pairs;
+
+    std::optional<EpipolarBand> epipolar_band;
+    EpipolarIndex right_index;
+    SparseCostMatrix sparse_costs;
+
+    LinearAssignment assignment;
+    std::vector<int> row_to_col;
+    std::vector<uint8_t> right_matched;     // greedy matching only
 
     static constexpr float VERTICAL_WEIGHT = 5.0f;
     static constexpr float HORIZONTAL_WEIGHT = 1.0f;
@@ -28,16 +70,23 @@ private:
     static constexpr float SIZE_WEIGHT = 2.0f;
     static constexpr float CLASS_MISMATCH_PENALTY = 150.0f;
 
-    std::vector<std::vector<int>> computeCostMatrix(
+    void computeCostMatrix(
         const std::vector<TrackingResult>& left_tracks,
         const std::vector<TrackingResult>& right_tracks
     );
 
+    void computeSparseCosts(
+        const std::vector<TrackingResult>& left_tracks,
+        const std::vector<TrackingResult>& right_tracks
+    );
+
+    float pairCost(int left, int right) const;
+
     static float computeBoxArea(const TrackingResult& track);
     static cv::Point2f computeBoxCenter(const TrackingResult& track);
 
-    std::vector<StereoPair> greedyMatch(const std::vector<std::vector<int>>& cost_matrix,
-                                       const std::vector<TrackingResult>& left_tracks,
-                                       const std::vector<TrackingResult>& right_tracks);
+    // both fill row_to_col from candidate_pairs / the cost matrix currently built
+    void greedyMatch(int left_count, int right_count);
+    void optimalMatch(int left_count, int right_count);
 
 };
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "StereoRectifier.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    void readCalibration(const std::string& path, StereoCalibration& calibration) {
+        cv::FileStorage fs(path, cv::FileStorage::READ);
+        if (!fs.isOpened()) {
+            throw std::runtime_error("Failed to open stereo calibration: " + path);
+        }
+
+        auto read_if_present = [&fs](const char* key, cv::Mat& target) {
+            if (!fs[key].empty()) fs[key] >> target;
+        };
+        read_if_present("M1", calibration.M1);
+        read_if_present("D1", calibration.D1);
+        read_if_present("M2", calibration.M2);
+        read_if_present("D2", calibration.D2);
+        read_if_present("R", calibration.R);
+        read_if_present("T", calibration.T);
+        read_if_present("R1", calibration.R1);
+        read_if_present("R2", calibration.R2);
+        read_if_present("P1", calibration.P1);
+        read_if_present("P2", calibration.P2);
+        read_if_present("Q", calibration.Q);
+
+        if (!fs["image_width"].empty() && !fs["image_height"].empty()) {
+            calibration.image_size = cv::Size(static_cast<int>(fs["image_width"]),
+                                              static_cast<int>(fs["image_height"]));
+        }
+    }
+
+    void validate(const StereoCalibration& calibration) {
+        if (calibration.M1.empty() || calibration.M2.empty() ||
+            calibration.R.empty() || calibration.T.empty()) {
+            throw std::runtime_error("Stereo calibration needs at least M1, M2, R and T");
+        }
+        if (calibration.image_size.area() <= 0) {
+            throw std::runtime_error("Stereo calibration has no image size");
+        }
+    }
+}
+
+StereoCalibration StereoCalibration::load(const std::string& path, cv::Size image_size) {
+    return load(path, path, image_size);
+}
+
+StereoCalibration StereoCalibration::load(const std::string& intrinsics_path,
+                                          const std::string& extrinsics_path,
+                                          cv::Size image_size) {
+    StereoCalibration calibration;
+    calibration.image_size = image_size;
+    readCalibration(intrinsics_path, calibration);
+    if (extrinsics_path != intrinsics_path) {
+        readCalibration(extrinsics_path, calibration);
+    }
+    if (image_size.area() > 0) calibration.image_size = image_size;
+
+    validate(calibration);
+    return calibration;
+}
+
+StereoRectifier::StereoRectifier(const StereoCalibration& calibration, int table_stride)
+    : image_size(calibration.image_size)
+    , stride(std::max(1, table_stride)) {
+    cv::Mat R1 = calibration.R1, R2 = calibration.R2;
+    P1 = calibration.P1;
+    P2 = calibration.P2;
+    Q = calibration.Q;
+
+    if (R1.empty() || R2.empty() || P1.empty() || P2.empty() || Q.empty()) {
+        cv::stereoRectify(calibration.M1, calibration.D1, calibration.M2, calibration.D2,
+                          image_size, calibration.R, calibration.T,
+                          R1, R2, P1, P2, Q, cv::CALIB_ZERO_DISPARITY, 0);
+    }
+
+    left_table = buildTable(calibration.M1, calibration.D1, R1, P1);
+    right_table = buildTable(calibration.M2, calibration.D2, R2, P2);
+}
+
+// the undistort/rectify maps from initUndistortRectifyMap point from rectified to raw pixels;
+// boxes need the opposite direction, so the grid is pushed through undistortPoints instead
+cv::Mat StereoRectifier::buildTable(const cv::Mat& camera_matrix, const cv::Mat& distortion,
+                                    const cv::Mat& rotation, const cv::Mat& projection) const {
+    const int cols = (image_size.width + stride - 1) / stride + 1;
+    const int rows = (image_size.height + stride - 1) / stride + 1;
+
+    std::vector<cv::Point2f> raw_points;
+    raw_points.reserve(static_cast<size_t>(rows) * cols);
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            raw_points.emplace_back(static_cast<float>(x * stride), static_cast<float>(y * stride));
+        }
+    }
+
+    std::vector<cv::Point2f> rectified_points;
+    cv::undistortPoints(raw_points, rectified_points, camera_matrix, distortion, rotation, projection);
+
+    return cv::Mat(rectified_points, true).reshape(2, rows);
+}
+
+cv::Point2f StereoRectifier::rectifyPoint(Side side, const cv::Point2f& point) const {
+    const cv::Mat& table = side == Side::Left ? left_table : right_table;
+
+    const float gx = std::clamp(point.x / stride, 0.0f, static_cast<float>(table.cols - 1));
+    const float gy = std::clamp(point.y / stride, 0.0f, static_cast<float>(table.rows - 1));
+    const int x0 = std::min(static_cast<int>(gx), table.cols - 2);
+    const int y0 = std::min(static_cast<int>(gy), table.rows - 2);
+    const float fx = gx - x0;
+    const float fy = gy - y0;
+
+    const cv::Point2f* row0 = table.ptr<cv::Point2f>(y0);
+    const cv::Point2f* row1 = table.ptr<cv::Point2f>(y0 + 1);
+    cv::Point2f top = row0[x0] * (1.0f - fx) + row0[x0 + 1] * fx;
+    cv::Point2f bottom = row1[x0] * (1.0f - fx) + row1[x0 + 1] * fx;
+    return top * (1.0f - fy) + bottom * fy;
+}
+
+void StereoRectifier::rectify(Side side, std::vector<TrackingResult>& tracks) const {
+    for (auto& track : tracks) {
+        const float mid_x = (track.x1 + track.x2) * 0.5f;
+        const float mid_y = (track.y1 + track.y2) * 0.5f;
+
+        // corners plus edge midpoints, lens distortion bends the edges
+        const cv::Point2f outline[] = {
+            {track.x1, track.y1}, {mid_x, track.y1}, {track.x2, track.y1},
+            {track.x2, mid_y}, {track.x2, track.y2}, {mid_x, track.y2},
+            {track.x1, track.y2}, {track.x1, mid_y}
+        };
+
+        float x1 = std::numeric_limits<float>::max(), y1 = x1;
+        float x2 = std::numeric_limits<float>::lowest(), y2 = x2;
+        for (const auto& point : outline) {
+            cv::Point2f rectified = rectifyPoint(side, point);
+            x1 = std::min(x1, rectified.x);
+            y1 = std::min(y1, rectified.y);
+            x2 = std::max(x2, rectified.x);
+            y2 = std::max(y2, rectified.y);
+        }
+
+        track.x1 = x1;
+        track.y1 = y1;
+        track.x2 = x2;
+        track.y2 = y2;
+    }
+}
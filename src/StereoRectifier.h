@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "OCSortTracker.h"
+
+// intrinsics / extrinsics as written by cv::stereoCalibrate (keys of OpenCV's stereo_calib sample:
+// M1 D1 M2 D2 R T, optionally R1 R2 P1 P2 Q when stereoRectify was already run)
+struct StereoCalibration {
+    cv::Size image_size;
+    cv::Mat M1, D1, M2, D2;
+    cv::Mat R, T;
+    cv::Mat R1, R2, P1, P2, Q;
+
+    // image_size is read from image_width / image_height when the file has them
+    static StereoCalibration load(const std::string& path, cv::Size image_size = {});
+    static StereoCalibration load(const std::string& intrinsics_path,
+                                  const std::string& extrinsics_path,
+                                  cv::Size image_size = {});
+};
+
+// maps boxes from raw camera pixels into the rectified stereo frame, where matching can rely on
+// pure horizontal disparity. the raw -> rectified mapping is tabulated once on a coarse grid, so
+// per frame only a handful of points per box are looked up instead of remapping whole images.
+class StereoRectifier {
+public:
+    enum class Side { Left, Right };
+
+    explicit StereoRectifier(const StereoCalibration& calibration, int table_stride = 8);
+
+    cv::Point2f rectifyPoint(Side side, const cv::Point2f& point) const;
+
+    // in place, the box becomes the bounding box of its rectified outline
+    void rectify(Side side, std::vector<TrackingResult>& tracks) const;
+
+    const cv::Mat& projectionLeft() const { return P1; }
+    const cv::Mat& projectionRight() const { return P2; }
+    const cv::Mat& disparityToDepth() const { return Q; }
+    cv::Size imageSize() const { return image_size; }
+
+private:
+    cv::Size image_size;
+    int stride;
+    cv::Mat P1, P2, Q;
+    cv::Mat left_table;     // CV_32FC2, rectified position of every stride-th raw pixel
+    cv::Mat right_table;
+
+    cv::Mat buildTable(const cv::Mat& camera_matrix, const cv::Mat& distortion,
+                       const cv::Mat& rotation, const cv::Mat& projection) const;
+};
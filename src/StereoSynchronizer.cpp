@@ -0,0 +1,98 @@
+#include "StereoSynchronizer.h"
+#include <algorithm>
+#include <cstdlib>
+
+StereoSynchronizer::StereoSynchronizer(std::chrono::microseconds tolerance,
+                                       size_t frames_per_side,
+                                       PairSink sink)
+    : tolerance_ns_(std::chrono::duration_cast<std::chrono::nanoseconds>(tolerance).count())
+    , frames_per_side_(std::max<size_t>(1, frames_per_side))
+    , sink_(std::move(sink)) {
+    left_.reserve(frames_per_side_ + 1);
+    right_.reserve(frames_per_side_ + 1);
+    ready_.reserve(frames_per_side_ + 1);
+}
+
+void StereoSynchronizer::push(Side side, CapturedFrame&& frame) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    auto& buffer = side == Side::Left ? left_ : right_;
+    delivered_.wait(lock, [&] { return !delivering_ || buffer.size() < frames_per_side_; });
+    buffer.push_back(std::move(frame));
+    if (buffer.size() > frames_per_side_) {
+        buffer.erase(buffer.begin());
+        (side == Side::Left ? dropped_left_ : dropped_right_)++;
+    }
+
+    match();
+    deliver(lock);
+}
+
+// the lock is only dropped around the sink call. checking for pairs and clearing delivering_
+// happen under it, so a pair queued by the other thread meanwhile is never left behind
+void StereoSynchronizer::deliver(std::unique_lock<std::mutex>& lock) {
+    if (delivering_ || ready_.empty()) return;
+
+    delivering_ = true;
+    while (!ready_.empty()) {
+        Pair pair = std::move(ready_.front());
+        ready_.erase(ready_.begin());
+
+        lock.unlock();
+        sink_(std::move(pair.left), std::move(pair.right));
+        lock.lock();
+    }
+    delivering_ = false;
+    delivered_.notify_all();
+}
+
+// both buffers are ordered by capture time, so the oldest frame overall can only ever pair
+// with the head of the other side
+void StereoSynchronizer::match() {
+    while (!left_.empty() && !right_.empty()) {
+        const bool left_older = left_.front().capture_ns <= right_.front().capture_ns;
+        auto& older = left_older ? left_ : right_;
+        auto& other = left_older ? right_ : left_;
+        uint64_t& older_dropped = left_older ? dropped_left_ : dropped_right_;
+
+        const int64_t target = other.front().capture_ns;
+        const int64_t skew = target - older.front().capture_ns;
+
+        // a later frame on the older side sits closer to the other head
+        if (older.size() > 1 && std::llabs(older[1].capture_ns - target) < skew) {
+            older.erase(older.begin());
+            older_dropped++;
+            continue;
+        }
+
+        // everything on the other side is newer still, the older frame can never pair
+        if (skew > tolerance_ns_) {
+            older.erase(older.begin());
+            older_dropped++;
+            continue;
+        }
+
+        CapturedFrame left = std::move(left_.front());
+        CapturedFrame right = std::move(right_.front());
+        left_.erase(left_.begin());
+        right_.erase(right_.begin());
+
+        left.sequence = right.sequence = next_pair_id_++;
+        pairs_++;
+        skew_sum_ns_ += skew;
+        skew_max_ns_ = std::max(skew_max_ns_, skew);
+
+        ready_.push_back({std::move(left), std::move(right)});
+    }
+}
+
+StereoSynchronizer::Stats StereoSynchronizer::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.pairs = pairs_;
+    stats.dropped_left = dropped_left_;
+    stats.dropped_right = dropped_right_;
+    stats.mean_skew_ms = pairs_ ? skew_sum_ns_ / 1e6 / pairs_ : 0.0;
+    stats.max_skew_ms = skew_max_ns_ / 1e6;
+    return stats;
+}
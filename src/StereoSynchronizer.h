@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include "FramePool.h"
+
+// pairs left/right captures whose timestamps lie within a tolerance. each side keeps a few
+// frames; frames that can no longer be paired are dropped before any inference is spent on them.
+class StereoSynchronizer {
+public:
+    enum class Side { Left, Right };
+
+    struct Stats {
+        uint64_t pairs = 0;
+        uint64_t dropped_left = 0;
+        uint64_t dropped_right = 0;
+        double mean_skew_ms = 0.0;
+        double max_skew_ms = 0.0;
+    };
+
+    // receives both frames of a pair, already stamped with a shared pair id
+    using PairSink = std::function<void(CapturedFrame&& left, CapturedFrame&& right)>;
+
+    StereoSynchronizer(std::chrono::microseconds tolerance,
+                       size_t frames_per_side,
+                       PairSink sink);
+
+    // thread-safe. the sink runs on one of the pushing threads, outside the synchronizer's lock, one
+    // pair at a time and in pair order. while a sink call blocks (a full lossless queue), the other
+    // side keeps buffering and only waits once its buffer is full, instead of dropping frames;
+    // pairs it completes meanwhile are handed over by the delivering thread
+    void push(Side side, CapturedFrame&& frame);
+
+    Stats stats() const;
+
+private:
+    const int64_t tolerance_ns_;
+    const size_t frames_per_side_;
+    PairSink sink_;
+
+    struct Pair {
+        CapturedFrame left;
+        CapturedFrame right;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<CapturedFrame> left_;
+    std::vector<CapturedFrame> right_;
+    std::vector<Pair> ready_;       // matched, waiting for the sink
+    bool delivering_ = false;       // some thread is running the sink
+    std::condition_variable delivered_;
+    uint64_t next_pair_id_ = 0;
+
+    uint64_t pairs_ = 0;
+    uint64_t dropped_left_ = 0;
+    uint64_t dropped_right_ = 0;
+    int64_t skew_sum_ns_ = 0;
+    int64_t skew_max_ns_ = 0;
+
+    void match();
+    void deliver(std::unique_lock<std::mutex>& lock);
+};
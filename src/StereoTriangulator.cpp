@@ -0,0 +1,126 @@
+#include "StereoTriangulator.h"
+#include <algorithm>
+#include <cmath>
+
+StereoTriangulator::StereoTriangulator(const StereoRectifier* rectifier, StereoGeometry geometry)
+    : rectifier(rectifier)
+    , geometry(geometry) {
+    if (rectifier) {
+        cv::Mat Q;
+        rectifier->disparityToDepth().convertTo(Q, CV_64F);
+        std::copy(Q.ptr<double>(), Q.ptr<double>() + 16, q);
+    }
+}
+
+bool StereoTriangulator::triangulate(const cv::Point2f& left, const cv::Point2f& right,
+                                     cv::Point3f& point) const {
+    // same sign as StereoMatcher: positive in front of the rig, anything else can't be triangulated
+    const float disparity = left.x - right.x;
+    if (disparity < MIN_DISPARITY) return false;
+
+    if (rectifier) {
+        // [X Y Z W]^T = Q [x y d 1]^T; Q carries the sign of the baseline
+        const double in[4] = {left.x, left.y, disparity, 1.0};
+        double out[4];
+        for (int r = 0; r < 4; r++) {
+            out[r] = q[r * 4] * in[0] + q[r * 4 + 1] * in[1] + q[r * 4 + 2] * in[2] + q[r * 4 + 3] * in[3];
+        }
+        if (std::abs(out[3]) < 1e-12) return false;
+
+        point = cv::Point3f(static_cast<float>(out[0] / out[3]),
+                            static_cast<float>(out[1] / out[3]),
+                            static_cast<float>(out[2] / out[3]));
+    } else {
+        const float depth = geometry.focal_px * geometry.baseline / disparity;
+        point = cv::Point3f((left.x - geometry.principal_point.x) * depth / geometry.focal_px,
+                            (left.y - geometry.principal_point.y) * depth / geometry.focal_px,
+                            depth);
+    }
+    return point.z > 0.0f;
+}
+
+StereoTriangulator::Filter& StereoTriangulator::filterFor(int super_id, const cv::Point3f& initial,
+                                                          int64_t timestamp_ns) {
+    auto it = filters.find(super_id);
+    if (it != filters.end()) return it->second;
+
+    Filter& filter = filters[super_id];
+    filter.kalman.init(6, 3, 0, CV_32F);
+    filter.kalman.transitionMatrix = cv::Mat::eye(6, 6, CV_32F);
+    filter.kalman.measurementMatrix = cv::Mat::eye(3, 6, CV_32F);
+    cv::setIdentity(filter.kalman.measurementNoiseCov, cv::Scalar::all(MEASUREMENT_NOISE));
+    cv::setIdentity(filter.kalman.errorCovPost, cv::Scalar::all(1.0));
+
+    filter.kalman.statePost = cv::Mat::zeros(6, 1, CV_32F);
+    filter.kalman.statePost.at<float>(0) = initial.x;
+    filter.kalman.statePost.at<float>(1) = initial.y;
+    filter.kalman.statePost.at<float>(2) = initial.z;
+    filter.last_update_ns = timestamp_ns;
+    return filter;
+}
+
+std::vector<StereoObject> StereoTriangulator::update(const std::vector<StereoPair>& pairs,
+                                                     const std::vector<TrackingResult>& left_tracks,
+                                                     const std::vector<TrackingResult>& right_tracks,
+                                                     const SuperIdRegistry& super_ids,
+                                                     int64_t timestamp_ns) {
+    left_index.clear();
+    right_index.clear();
+    for (size_t i = 0; i < left_tracks.size(); i++) left_index[left_tracks[i].track_id] = i;
+    for (size_t i = 0; i < right_tracks.size(); i++) right_index[right_tracks[i].track_id] = i;
+
+    std::vector<StereoObject> objects;
+    objects.reserve(pairs.size());
+
+    for (const auto& pair : pairs) {
+        const int super_id = super_ids.superId(SuperIdRegistry::Side::Left, pair.left_id);
+        auto left_it = left_index.find(pair.left_id);
+        auto right_it = right_index.find(pair.right_id);
+        if (super_id == SuperIdRegistry::NONE || left_it == left_index.end() || right_it == right_index.end()) {
+            continue;
+        }
+
+        const TrackingResult& left = left_tracks[left_it->second];
+        const TrackingResult& right = right_tracks[right_it->second];
+        const cv::Point2f left_center((left.x1 + left.x2) * 0.5f, (left.y1 + left.y2) * 0.5f);
+        const cv::Point2f right_center((right.x1 + right.x2) * 0.5f, (right.y1 + right.y2) * 0.5f);
+
+        cv::Point3f measured;
+        if (!triangulate(left_center, right_center, measured)) continue;
+
+        Filter& filter = filterFor(super_id, measured, timestamp_ns);
+        const float dt = std::max(1e-3f, (timestamp_ns - filter.last_update_ns) / 1e9f);
+        filter.last_update_ns = timestamp_ns;
+
+        // constant velocity model over the actual frame interval
+        for (int axis = 0; axis < 3; axis++) {
+            filter.kalman.transitionMatrix.at<float>(axis, axis + 3) = dt;
+        }
+        cv::setIdentity(filter.kalman.processNoiseCov, cv::Scalar::all(PROCESS_NOISE * dt));
+
+        filter.kalman.predict();
+        cv::Mat measurement = (cv::Mat_<float>(3, 1) << measured.x, measured.y, measured.z);
+        const cv::Mat& state = filter.kalman.correct(measurement);
+
+        StereoObject object;
+        object.super_id = super_id;
+        object.left_id = pair.left_id;
+        object.right_id = pair.right_id;
+        object.class_id = left.class_id;
+        object.disparity = left_center.x - right_center.x;
+        object.measured = measured;
+        object.position = cv::Point3f(state.at<float>(0), state.at<float>(1), state.at<float>(2));
+        object.velocity = cv::Point3f(state.at<float>(3), state.at<float>(4), state.at<float>(5));
+        objects.push_back(object);
+    }
+
+    for (auto it = filters.begin(); it != filters.end();) {
+        if (timestamp_ns - it->second.last_update_ns > MAX_IDLE_NS) {
+            it = filters.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    return objects;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <opencv2/video/tracking.hpp>
+#include "OCSortTracker.h"
+#include "StereoMatcher.h"
+#include "StereoRectifier.h"
+#include "SuperIdRegistry.h"
+
+// one matched stereo object in the left (reference) camera frame, in calibration units (usually m)
+struct StereoObject {
+    int super_id;
+    int left_id;
+    int right_id;
+    int class_id;
+    float disparity;            // rectified x_left - x_right, pixels
+    cv::Point3f measured;       // raw triangulation of this frame
+    cv::Point3f position;       // Kalman-smoothed
+    cv::Point3f velocity;       // units per second
+};
+
+// pinhole parameters for rigs without a calibration file
+struct StereoGeometry {
+    float focal_px = 600.0f;
+    float baseline = 0.12f;
+    cv::Point2f principal_point{320.0f, 240.0f};
+};
+
+// turns matched box pairs into 3D positions (box centers, no dense disparity) and smooths each
+// super ID with a constant-velocity Kalman filter
+class StereoTriangulator {
+public:
+    explicit StereoTriangulator(const StereoRectifier* rectifier = nullptr,
+                                StereoGeometry geometry = {});
+
+    // tracks must be in the frame the pairs were matched in (rectified when a rectifier is set)
+    std::vector<StereoObject> update(const std::vector<StereoPair>& pairs,
+                                     const std::vector<TrackingResult>& left_tracks,
+                                     const std::vector<TrackingResult>& right_tracks,
+                                     const SuperIdRegistry& super_ids,
+                                     int64_t timestamp_ns);
+
+private:
+    struct Filter {
+        cv::KalmanFilter kalman;
+        int64_t last_update_ns = 0;
+    };
+
+    const StereoRectifier* rectifier;
+    StereoGeometry geometry;
+    double q[16] = {};      // rectifier's Q, row-major
+    std::unordered_map<int, Filter> filters;
+    std::unordered_map<int, size_t> left_index;
+    std::unordered_map<int, size_t> right_index;
+
+    static constexpr int64_t MAX_IDLE_NS = 2'000'000'000;
+    static constexpr float MIN_DISPARITY = 0.5f;      // px, smaller or negative ones are rejected
+    static constexpr float PROCESS_NOISE = 1.0f;
+    static constexpr float MEASUREMENT_NOISE = 0.05f;
+
+    bool triangulate(const cv::Point2f& left, const cv::Point2f& right, cv::Point3f& point) const;
+    Filter& filterFor(int super_id, const cv::Point3f& initial, int64_t timestamp_ns);
+};
@@ -0,0 +1,112 @@
+#include "SuperIdRegistry.h"
+
+SuperIdRegistry::SuperIdRegistry(int max_idle_frames)
+    : MAX_IDLE_FRAMES(static_cast<uint64_t>(max_idle_frames)) {}
+
+void SuperIdRegistry::beginFrame(const std::vector<TrackingResult>& left_tracks,
+                                 const std::vector<TrackingResult>& right_tracks) {
+    frame++;
+    stamp(left, left_tracks);
+    stamp(right, right_tracks);
+    evict(left, Side::Left);
+    evict(right, Side::Right);
+}
+
+void SuperIdRegistry::assign(const std::vector<StereoPair>& pairs) {
+    for (const auto& pair : pairs) {
+        assign(pair.left_id, pair.right_id);
+    }
+}
+
+int SuperIdRegistry::assign(int left_id, int right_id) {
+    const int left_super = superId(Side::Left, left_id);
+    const int right_super = superId(Side::Right, right_id);
+
+    int super_id;
+    if (left_super == NONE && right_super == NONE) {
+        super_id = next_super_id++;
+        supers[super_id].first_frame = frame;
+    } else if (right_super == NONE || left_super == right_super) {
+        super_id = left_super;
+    } else if (left_super == NONE) {
+        super_id = right_super;
+    } else {
+        // both sides already belong to different objects: keep the longer-lived id so the
+        // established identity survives a one-frame mismatch
+        const SuperEntry* l = supers.find(left_super);
+        const SuperEntry* r = supers.find(right_super);
+        const bool left_older = l->first_frame < r->first_frame ||
+                                (l->first_frame == r->first_frame && left_super < right_super);
+        super_id = left_older ? left_super : right_super;
+        conflict_count++;
+    }
+
+    link(super_id, Side::Left, left_id);
+    link(super_id, Side::Right, right_id);
+    return super_id;
+}
+
+int SuperIdRegistry::superId(Side side, int track_id) const {
+    const TrackEntry* entry = (side == Side::Left ? left : right).find(track_id);
+    return entry ? entry->super_id : NONE;
+}
+
+void SuperIdRegistry::link(int super_id, Side side, int track_id) {
+    FlatIdMap<TrackEntry>& tracks = side == Side::Left ? left : right;
+
+    TrackEntry& entry = tracks[track_id];
+    entry.last_seen = frame;
+    const int previous_super = entry.super_id;
+    if (previous_super == super_id) return;
+
+    // the track leaves its old object
+    if (previous_super != NONE) unlink(side, track_id);
+
+    // take over the object's slot on this side first, so dropping the displaced track can't
+    // leave the object empty and erase it
+    SuperEntry* super = supers.find(super_id);
+    int& slot = side == Side::Left ? super->left_id : super->right_id;
+    const int displaced = slot;
+    slot = track_id;
+    if (displaced != NONE && displaced != track_id) unlink(side, displaced);
+
+    // unlink erased entries and shifted slots, look the track up again
+    TrackEntry& linked = tracks[track_id];
+    linked.super_id = super_id;
+    linked.last_seen = frame;
+}
+
+void SuperIdRegistry::unlink(Side side, int track_id) {
+    FlatIdMap<TrackEntry>& tracks = side == Side::Left ? left : right;
+    const TrackEntry* entry = tracks.find(track_id);
+    if (!entry) return;
+
+    const int super_id = entry->super_id;
+    tracks.erase(track_id);
+    if (super_id == NONE) return;
+
+    SuperEntry* super = supers.find(super_id);
+    if (!super) return;
+    int& slot = side == Side::Left ? super->left_id : super->right_id;
+    if (slot == track_id) slot = NONE;
+    if (super->left_id == NONE && super->right_id == NONE) supers.erase(super_id);
+}
+
+void SuperIdRegistry::stamp(FlatIdMap<TrackEntry>& tracks, const std::vector<TrackingResult>& results) {
+    for (const auto& result : results) {
+        if (TrackEntry* entry = tracks.find(result.track_id)) entry->last_seen = frame;
+    }
+}
+
+void SuperIdRegistry::evict(FlatIdMap<TrackEntry>& tracks, Side side) {
+    tracks.eraseIf([&](int track_id, const TrackEntry& entry) {
+        if (frame - entry.last_seen <= MAX_IDLE_FRAMES) return false;
+
+        if (SuperEntry* super = supers.find(entry.super_id)) {
+            int& slot = side == Side::Left ? super->left_id : super->right_id;
+            if (slot == track_id) slot = NONE;
+            if (super->left_id == NONE && super->right_id == NONE) supers.erase(entry.super_id);
+        }
+        return true;
+    });
+}
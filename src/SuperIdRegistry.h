@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "FlatIdMap.h"
+#include "OCSortTracker.h"
+#include "StereoMatcher.h"
+
+// stable ids for objects seen by both cameras. each super id links at most one left and one
+// right track; track ids that stop showing up in the tracker output are evicted, so the tables
+// stay bounded no matter how many ids the trackers hand out over a long run.
+class SuperIdRegistry {
+public:
+    enum class Side { Left, Right };
+
+    static constexpr int NONE = -1;
+
+    // max_idle_frames should be at least the tracker's max_age: a track missing from the output
+    // for that long has been deleted by OC-SORT and its id never comes back
+    explicit SuperIdRegistry(int max_idle_frames = 50);
+
+    // once per stereo frame with the tracker outputs, before assign(); stamps the live tracks
+    // and evicts the dead ones
+    void beginFrame(const std::vector<TrackingResult>& left_tracks,
+                    const std::vector<TrackingResult>& right_tracks);
+
+    // links a matched pair and returns its super id. when both tracks already carry different
+    // super ids the older one wins and the other side's previous partner is unlinked
+    int assign(int left_id, int right_id);
+    void assign(const std::vector<StereoPair>& pairs);
+
+    int superId(Side side, int track_id) const;
+
+    size_t size() const { return supers.size(); }
+    size_t trackCount() const { return left.size() + right.size(); }
+    uint64_t conflicts() const { return conflict_count; }
+
+private:
+    struct TrackEntry {
+        int super_id = NONE;
+        uint64_t last_seen = 0;
+    };
+
+    struct SuperEntry {
+        int left_id = NONE;
+        int right_id = NONE;
+        uint64_t first_frame = 0;
+    };
+
+    const uint64_t MAX_IDLE_FRAMES;
+    FlatIdMap<TrackEntry> left;
+    FlatIdMap<TrackEntry> right;
+    FlatIdMap<SuperEntry> supers;
+    uint64_t frame = 0;
+    int next_super_id = 0;
+    uint64_t conflict_count = 0;
+
+    void link(int super_id, Side side, int track_id);
+    void unlink(Side side, int track_id);
+    void stamp(FlatIdMap<TrackEntry>& tracks, const std::vector<TrackingResult>& results);
+    void evict(FlatIdMap<TrackEntry>& tracks, Side side);
+};
@@ -0,0 +1,34 @@
+#include "TileLayout.h"
+#include <algorithm>
+#include <stdexcept>
+
+// start positions along one axis: as few tiles as keep at least `overlap` px between neighbours
+static std::vector<int> tileStarts(int length, int tile, int overlap) {
+    if (length <= tile) return {0};
+
+    const int stride = tile - overlap;
+    const int count = (length - overlap + stride - 1) / stride;
+    std::vector<int> starts(count);
+    for (int i = 0; i < count; i++) {
+        starts[i] = static_cast<int>(static_cast<long long>(length - tile) * i / (count - 1));
+    }
+    return starts;
+}
+
+TileLayout TileLayout::compute(cv::Size frame_size, int tile_size, int overlap) {
+    if (tile_size <= 0 || overlap < 0 || overlap >= tile_size) {
+        throw std::runtime_error("Invalid tiling: tiles of " + std::to_string(tile_size) +
+                                 " px with " + std::to_string(overlap) + " px overlap");
+    }
+
+    TileLayout layout;
+    layout.frame_size = frame_size;
+    const int tile_w = std::min(tile_size, frame_size.width);
+    const int tile_h = std::min(tile_size, frame_size.height);
+    for (int y : tileStarts(frame_size.height, tile_size, overlap)) {
+        for (int x : tileStarts(frame_size.width, tile_size, overlap)) {
+            layout.tiles.emplace_back(x, y, tile_w, tile_h);
+        }
+    }
+    return layout;
+}
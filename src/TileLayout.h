@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+struct TilingOptions {
+    bool enabled = false;
+    int tile_size = 640;            // square tiles in frame pixels, each resized to the network input
+    int overlap = 128;              // px shared by neighbouring tiles, should exceed the smallest object
+    bool full_frame_view = true;    // also detect on the whole frame, for objects larger than a tile
+};
+
+// overlapping tiles covering a frame edge to edge; the stride is spread evenly, so the last tile
+// ends on the border instead of hanging over it. computed once per frame size
+struct TileLayout {
+    cv::Size frame_size;
+    std::vector<cv::Rect> tiles;
+
+    static TileLayout compute(cv::Size frame_size, int tile_size, int overlap);
+
+    // a tile edge that lies inside the frame, where a tile may have cut an object in two
+    bool interiorLeft(int tile) const { return tiles[tile].x > 0; }
+    bool interiorTop(int tile) const { return tiles[tile].y > 0; }
+    bool interiorRight(int tile) const { return tiles[tile].br().x < frame_size.width; }
+    bool interiorBottom(int tile) const { return tiles[tile].br().y < frame_size.height; }
+};
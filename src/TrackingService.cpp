@@ -0,0 +1,220 @@
+#include "TrackingService.h"
+#include <cstdlib>
+#include <numeric>
+#include <stdexcept>
+
+TrackingService::TrackingService(TrackingServiceConfig config)
+    : config_(std::move(config)) {
+    const size_t camera_count = config_.sources.size();
+    if (camera_count == 0) {
+        throw std::runtime_error("TrackingService needs at least one source");
+    }
+
+    FrameSourceOptions source_options;
+    source_options.pacing = config_.pacing;
+    source_options.width = config_.pipeline.capture_width;
+    source_options.height = config_.pipeline.capture_height;
+    source_options.fps = config_.pipeline.capture_fps;
+
+    detectors_ = std::make_unique<DetectorPool>(config_.model_path, camera_count, config_.detector_count,
+                                                0, config_.inference);
+    for (size_t i = 0; i < camera_count; i++) {
+        auto source = FrameSource::create(config_.sources[i], source_options);
+        lockstep_ = lockstep_ && !source->isLive();
+        pipelines_.push_back(std::make_unique<CameraPipeline>(
+            std::move(source), detectors_->detectorFor(i), config_.pipeline));
+    }
+
+    if (config_.links.empty()) {
+        // cameras listed as consecutive stereo rigs
+        for (size_t a = 0; a + 1 < camera_count; a += 2) links_.push_back({a, a + 1});
+    } else {
+        links_ = config_.links;
+    }
+
+    for (const auto& link : links_) {
+        if (link.left >= camera_count || link.right >= camera_count || link.left == link.right) {
+            throw std::runtime_error("Invalid camera link " + std::to_string(link.left) + " -> " +
+                                     std::to_string(link.right));
+        }
+        matchers_.push_back({link, StereoMatcher(config_.image_width)});
+    }
+
+    track_ids_.resize(camera_count);
+    track_nodes_.resize(camera_count);
+    camera_frames_.assign(camera_count, 0);
+}
+
+TrackingService::~TrackingService() {
+    stop();
+}
+
+void TrackingService::start() {
+    for (auto& pipeline : pipelines_) pipeline->start();
+}
+
+void TrackingService::stop() {
+    for (auto& pipeline : pipelines_) pipeline->stop();
+    detectors_->stop();
+}
+
+bool TrackingService::poll(TrackingSnapshot& snapshot) {
+    const size_t camera_count = pipelines_.size();
+    snapshot.cameras.resize(camera_count);
+    snapshot.updated.assign(camera_count, 0);
+    snapshot.global_ids.resize(camera_count);
+
+    if (lockstep_) {
+        for (const auto& pipeline : pipelines_) {
+            if (!pipeline->hasNewOutput() && !pipeline->finished()) return false;
+        }
+    }
+
+    bool any_new = false;
+    for (size_t c = 0; c < camera_count; c++) {
+        if (pipelines_[c]->fetchLatest(snapshot.cameras[c])) {
+            snapshot.updated[c] = 1;
+            camera_frames_[c]++;
+            any_new = true;
+        }
+    }
+    if (!any_new) return false;
+
+    associate(snapshot);
+    return true;
+}
+
+bool TrackingService::finished() const {
+    for (const auto& pipeline : pipelines_) {
+        if (!pipeline->finished()) return false;
+    }
+    return true;
+}
+
+int TrackingService::findRoot(int node) {
+    while (parent_[node] != node) {
+        parent_[node] = parent_[parent_[node]];
+        node = parent_[node];
+    }
+    return node;
+}
+
+void TrackingService::evictIdle() {
+    const uint64_t max_idle = static_cast<uint64_t>(config_.max_idle_frames);
+    for (size_t c = 0; c < track_ids_.size(); c++) {
+        const uint64_t now = camera_frames_[c];
+        track_ids_[c].eraseIf([&](int, const TrackEntry& entry) { return now - entry.last_seen > max_idle; });
+    }
+}
+
+void TrackingService::associate(TrackingSnapshot& snapshot) {
+    const size_t camera_count = pipelines_.size();
+
+    // every live track is a node, tracks matched by any link end up in one group
+    camera_offsets_.assign(camera_count + 1, 0);
+    for (size_t c = 0; c < camera_count; c++) {
+        camera_offsets_[c + 1] = camera_offsets_[c] + snapshot.cameras[c].tracks.size();
+    }
+    const int node_count = static_cast<int>(camera_offsets_[camera_count]);
+    parent_.resize(node_count);
+    std::iota(parent_.begin(), parent_.end(), 0);
+    group_size_.assign(node_count, 1);
+
+    for (size_t c = 0; c < camera_count; c++) {
+        const auto& tracks = snapshot.cameras[c].tracks;
+        track_nodes_[c].clear();
+        for (size_t i = 0; i < tracks.size(); i++) {
+            track_nodes_[c][tracks[i].track_id] = static_cast<int>(camera_offsets_[c] + i);
+            if (snapshot.updated[c]) {
+                if (TrackEntry* entry = track_ids_[c].find(tracks[i].track_id)) {
+                    entry->last_seen = camera_frames_[c];
+                }
+            }
+        }
+    }
+    evictIdle();
+
+    snapshot.matches.clear();
+    for (auto& link : matchers_) {
+        const auto& left = snapshot.cameras[link.cameras.left];
+        const auto& right = snapshot.cameras[link.cameras.right];
+        if (left.tracks.empty() || right.tracks.empty()) continue;
+
+        // a stalled camera keeps its last output around, don't match it against fresh frames
+        const int64_t skew_ns = std::abs(left.capture_ns - right.capture_ns);
+        if (skew_ns > std::chrono::duration_cast<std::chrono::nanoseconds>(config_.sync_tolerance).count()) {
+            continue;
+        }
+
+        for (const auto& pair : link.matcher.matchTracks(left.tracks, right.tracks)) {
+            int a = findRoot(*track_nodes_[link.cameras.left].find(pair.left_id));
+            int b = findRoot(*track_nodes_[link.cameras.right].find(pair.right_id));
+            if (a != b) {
+                if (group_size_[a] < group_size_[b]) std::swap(a, b);
+                parent_[b] = a;
+                group_size_[a] += group_size_[b];
+            }
+            snapshot.matches.push_back({link.cameras.left, link.cameras.right,
+                                        pair.left_id, pair.right_id, NO_GLOBAL_ID});
+        }
+    }
+
+    // a group keeps the oldest (lowest) id any of its tracks already carries
+    group_id_.assign(node_count, NO_GLOBAL_ID);
+    for (size_t c = 0; c < camera_count; c++) {
+        const auto& tracks = snapshot.cameras[c].tracks;
+        for (size_t i = 0; i < tracks.size(); i++) {
+            const int root = findRoot(static_cast<int>(camera_offsets_[c] + i));
+            if (group_size_[root] < 2) continue;
+            const TrackEntry* entry = track_ids_[c].find(tracks[i].track_id);
+            if (!entry || entry->global_id == NO_GLOBAL_ID) continue;
+            if (group_id_[root] == NO_GLOBAL_ID || entry->global_id < group_id_[root]) {
+                group_id_[root] = entry->global_id;
+            }
+        }
+    }
+
+    // two groups can inherit the same id after a split, the first keeps it
+    claimed_ids_.clear();
+    for (int node = 0; node < node_count; node++) {
+        if (parent_[node] != node || group_size_[node] < 2) continue;
+        int& id = group_id_[node];
+        if (id == NO_GLOBAL_ID || claimed_ids_.find(id)) id = next_global_id_++;
+        claimed_ids_[id] = 1;
+    }
+
+    for (size_t c = 0; c < camera_count; c++) {
+        const auto& tracks = snapshot.cameras[c].tracks;
+        auto& ids = snapshot.global_ids[c];
+        ids.assign(tracks.size(), NO_GLOBAL_ID);
+
+        claimed_ids_.clear();
+        for (size_t i = 0; i < tracks.size(); i++) {
+            const int root = findRoot(static_cast<int>(camera_offsets_[c] + i));
+            if (group_size_[root] < 2) continue;
+            TrackEntry& entry = track_ids_[c][tracks[i].track_id];
+            entry.global_id = group_id_[root];
+            entry.last_seen = camera_frames_[c];
+            ids[i] = entry.global_id;
+            claimed_ids_[entry.global_id] = 1;
+        }
+
+        // unmatched tracks keep their id while unmatched, unless a matched track of the same
+        // camera carries it now
+        for (size_t i = 0; i < tracks.size(); i++) {
+            if (ids[i] != NO_GLOBAL_ID) continue;
+            TrackEntry* entry = track_ids_[c].find(tracks[i].track_id);
+            if (!entry || entry->global_id == NO_GLOBAL_ID) continue;
+            if (claimed_ids_.find(entry->global_id)) {
+                entry->global_id = NO_GLOBAL_ID;
+            } else {
+                ids[i] = entry->global_id;
+            }
+        }
+    }
+
+    for (auto& match : snapshot.matches) {
+        const int node = *track_nodes_[match.left_camera].find(match.left_id);
+        match.global_id = group_id_[findRoot(node)];
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CameraPipeline.h"
+#include "DetectorPool.h"
+#include "FlatIdMap.h"
+#include "StereoMatcher.h"
+
+// a stereo rig whose tracks are matched; the matcher expects `right` to sit to the right of `left`.
+// cameras of different rigs are never matched: StereoMatcher's cost (same row, positive disparity)
+// has no meaning without shared epipolar geometry
+struct CameraLink {
+    size_t left;
+    size_t right;
+};
+
+struct TrackingServiceConfig {
+    std::vector<std::string> sources;           // FrameSource specs: camera index, video or image directory
+    Pacing pacing = Pacing::RealTime;           // for recorded sources
+    std::string model_path = "assets/yolov9-m.onnx";
+    size_t detector_count = 0;                  // 0: sized from the available cores
+    InferenceOptions inference;
+    PipelineConfig pipeline;
+    std::vector<CameraLink> links;              // stereo rigs, empty: (0,1), (2,3), ...
+    std::chrono::microseconds sync_tolerance = std::chrono::milliseconds(40);
+    float image_width = 640.0f;
+    int max_idle_frames = 50;                   // should cover the tracker's max_age
+};
+
+// one object seen by two linked cameras
+struct CrossCameraMatch {
+    size_t left_camera;
+    size_t right_camera;
+    int left_id;
+    int right_id;
+    int global_id;
+};
+
+struct TrackingSnapshot {
+    std::vector<CameraPipeline::Output> cameras;    // latest output per camera, kept until replaced
+    std::vector<uint8_t> updated;                   // cameras with new output in this snapshot
+    std::vector<std::vector<int>> global_ids;       // per camera, aligned with cameras[i].tracks
+    std::vector<CrossCameraMatch> matches;
+};
+
+// runs one capture/inference/tracking pipeline per camera on a shared detector pool and
+// associates tracks across cameras, so one process can serve a whole multi-camera host
+class TrackingService {
+public:
+    static constexpr int NO_GLOBAL_ID = -1;
+
+    explicit TrackingService(TrackingServiceConfig config);
+    ~TrackingService();
+
+    TrackingService(const TrackingService&) = delete;
+    TrackingService& operator=(const TrackingService&) = delete;
+
+    void start();
+    void stop();
+
+    // collects new pipeline output into snapshot and re-runs the association; false if no
+    // camera produced anything since the last call. with recorded sources only, it waits until
+    // every camera has its next frame, so offline runs associate identical frame sets each time
+    bool poll(TrackingSnapshot& snapshot);
+
+    // every source is a recording and all of it has been processed
+    bool finished() const;
+
+    size_t cameraCount() const { return pipelines_.size(); }
+    const std::vector<CameraLink>& links() const { return links_; }
+    uint64_t droppedFrames(size_t camera) const { return pipelines_[camera]->droppedFrames(); }
+
+private:
+    struct TrackEntry {
+        int global_id = NO_GLOBAL_ID;
+        uint64_t last_seen = 0;     // in frames of the track's own camera
+    };
+
+    struct Link {
+        CameraLink cameras;
+        StereoMatcher matcher;
+    };
+
+    const TrackingServiceConfig config_;
+    std::unique_ptr<DetectorPool> detectors_;
+    std::vector<std::unique_ptr<CameraPipeline>> pipelines_;
+    bool lockstep_ = true;      // all sources recorded: cameras advance together, frame by frame
+    std::vector<CameraLink> links_;
+    std::vector<Link> matchers_;
+
+    // association state, all reused between polls
+    std::vector<FlatIdMap<TrackEntry>> track_ids_;      // per camera: track id -> global id
+    std::vector<FlatIdMap<int>> track_nodes_;           // per camera: track id -> node, this poll
+    std::vector<size_t> camera_offsets_;
+    std::vector<int> parent_;
+    std::vector<int> group_size_;
+    std::vector<int> group_id_;
+    FlatIdMap<uint8_t> claimed_ids_;
+    std::vector<uint64_t> camera_frames_;               // outputs received per camera
+    int next_global_id_ = 0;
+
+    void associate(TrackingSnapshot& snapshot);
+    int findRoot(int node);
+    void evictIdle();
+};
@@ -0,0 +1,109 @@
+#include "YoloDecoder.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <stdexcept>
+
+void DetectionCandidates::clear() {
+    x1.clear();
+    y1.clear();
+    x2.clear();
+    y2.clear();
+    score.clear();
+    class_id.clear();
+}
+
+void DetectionCandidates::reserve(size_t capacity) {
+    x1.reserve(capacity);
+    y1.reserve(capacity);
+    x2.reserve(capacity);
+    y2.reserve(capacity);
+    score.reserve(capacity);
+    class_id.reserve(capacity);
+}
+
+void DetectionCandidates::push(float bx1, float by1, float bx2, float by2, float conf, int cls) {
+    x1.push_back(bx1);
+    y1.push_back(by1);
+    x2.push_back(bx2);
+    y2.push_back(by2);
+    score.push_back(conf);
+    class_id.push_back(cls);
+}
+
+YoloDecoder::YoloDecoder(float conf_threshold)
+    : CONFIDENCE_THRESHOLD(conf_threshold) {}
+
+void YoloDecoder::decode(const cv::Mat& output, const BoxTransform& transform,
+                         DetectionCandidates& out) const {
+    if (output.type() != CV_32F || !output.isContinuous() || output.dims < 2) {
+        throw std::runtime_error("Unexpected YOLO output layout");
+    }
+    // (1, 4 + classes, anchors) or (4 + classes, anchors)
+    const int num_channels = output.size[output.dims - 2];
+    const int num_anchors = output.size[output.dims - 1];
+    decode(output.ptr<float>(), num_channels, num_anchors, transform, out);
+}
+
+void YoloDecoder::decode(const float* output, int num_channels, int num_anchors,
+                         const BoxTransform& transform, DetectionCandidates& out) const {
+    const int num_classes = num_channels - 4;
+    if (num_classes <= 0) return;
+
+    const float* cx_row = output;
+    const float* cy_row = output + num_anchors;
+    const float* w_row = output + 2 * num_anchors;
+    const float* h_row = output + 3 * num_anchors;
+    const float* score_rows = output + 4 * num_anchors;
+
+    // running per-anchor maximum over classes, one chunk of anchors at a time so each
+    // class row is streamed contiguously instead of gathering a strided column per anchor
+    alignas(64) float best[ANCHOR_CHUNK];
+    alignas(64) int best_class[ANCHOR_CHUNK];
+
+    for (int base = 0; base < num_anchors; base += ANCHOR_CHUNK) {
+        const int count = std::min(ANCHOR_CHUNK, num_anchors - base);
+
+        std::copy_n(score_rows + base, count, best);
+        std::fill_n(best_class, count, 0);
+
+        for (int c = 1; c < num_classes; ++c) {
+            const float* row = score_rows + static_cast<size_t>(c) * num_anchors + base;
+            int j = 0;
+
+#if (CV_SIMD || CV_SIMD_SCALABLE)
+            const int lanes = cv::VTraits<cv::v_float32>::vlanes();
+            const cv::v_int32 v_class = cv::vx_setall_s32(c);
+            for (; j <= count - lanes; j += lanes) {
+                cv::v_float32 s = cv::vx_load(row + j);
+                cv::v_float32 b = cv::vx_load(best + j);
+                cv::v_float32 m = cv::v_gt(s, b);
+                cv::v_store(best + j, cv::v_select(m, s, b));
+                cv::v_int32 idx = cv::vx_load(best_class + j);
+                cv::v_store(best_class + j, cv::v_select(cv::v_reinterpret_as_s32(m), v_class, idx));
+            }
+#endif
+            // strict '>' keeps the first maximum, same as cv::minMaxLoc
+            for (; j < count; ++j) {
+                if (row[j] > best[j]) {
+                    best[j] = row[j];
+                    best_class[j] = c;
+                }
+            }
+        }
+
+        for (int j = 0; j < count; ++j) {
+            if (best[j] <= CONFIDENCE_THRESHOLD) continue;
+
+            const int a = base + j;
+            const float half_w = w_row[a] * 0.5f;
+            const float half_h = h_row[a] * 0.5f;
+
+            out.push((cx_row[a] - half_w) * transform.scale_x + transform.offset_x,
+                     (cy_row[a] - half_h) * transform.scale_y + transform.offset_y,
+                     (cx_row[a] + half_w) * transform.scale_x + transform.offset_x,
+                     (cy_row[a] + half_h) * transform.scale_y + transform.offset_y,
+                     best[j],
+                     best_class[j]);
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+// maps network-space coordinates back to image space: img = net * scale + offset
+struct BoxTransform {
+    float scale_x = 1.0f;
+    float scale_y = 1.0f;
+    float offset_x = 0.0f;
+    float offset_y = 0.0f;
+};
+
+// structure-of-arrays buffer of decoded boxes, reused between frames
+struct DetectionCandidates {
+    std::vector<float> x1, y1, x2, y2;
+    std::vector<float> score;
+    std::vector<int> class_id;
+
+    size_t size() const { return score.size(); }
+    bool empty() const { return score.empty(); }
+    void clear();
+    void reserve(size_t capacity);
+    void push(float bx1, float by1, float bx2, float by2, float conf, int cls);
+};
+
+class YoloDecoder {
+public:
+    explicit YoloDecoder(float conf_threshold = 0.4f);
+
+    // output is channel-major: (4 + num_classes) rows of num_anchors values (cx, cy, w, h, scores...)
+    // survivors are appended to out, so several outputs (e.g. tiles) can share one buffer
+    void decode(const float* output, int num_channels, int num_anchors,
+                const BoxTransform& transform, DetectionCandidates& out) const;
+
+    void decode(const cv::Mat& output, const BoxTransform& transform, DetectionCandidates& out) const;
+
+private:
+    const float CONFIDENCE_THRESHOLD;
+    static constexpr int ANCHOR_CHUNK = 256;
+};
@@ -1,143 +1,459 @@
 #include "YoloDetector.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
 #include <stdexcept>
 
 namespace {
-    bool checkCudaSupport() {
-        int device_count = cv::cuda::getCudaEnabledDeviceCount();
+    using Clock = std::chrono::steady_clock;
 
-        #ifndef NDEBUG
-                std::cout << "Number of CUDA devices: " << device_count << std::endl;
-        #endif
-
-        if (device_count > 0) {
-            for (int i = 0; i < device_count; ++i) {
-                cv::cuda::printShortCudaDeviceInfo(i);
-            }
-            return true;
-        } else {
-
-        #ifndef NDEBUG
-                    std::cout << "No CUDA-enabled devices found." << std::endl;
-        #endif
+    double millisBetween(Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
 
-        return false;
-        }
+    NmsOptions nmsOptions(float conf_threshold, float nms_threshold) {
+        NmsOptions options;
+        options.score_threshold = conf_threshold;
+        options.iou_threshold = nms_threshold;
+        return options;
     }
 
-    bool checkOpenCLsupport() {
-        return cv::ocl::haveOpenCL();
+    // the stage clocks are read anyway, exporting them costs a few atomic adds
+    void recordStageMetrics(const YoloDetector::StageTimings& timings) {
+        static LatencyHistogram& preprocess = stageHistogram("preprocess");
+        static LatencyHistogram& inference = stageHistogram("inference");
+        static LatencyHistogram& postprocess = stageHistogram("postprocess");
+        static LatencyHistogram& detect = stageHistogram("detect");
+
+        preprocess.recordMillis(timings.preprocess_ms);
+        inference.recordMillis(timings.inference_ms);
+        postprocess.recordMillis(timings.postprocess_ms);
+        detect.recordMillis(timings.preprocess_ms + timings.inference_ms + timings.postprocess_ms);
     }
 }
 
 YoloDetector::YoloDetector(const std::string& model_path, 
                           float conf_threshold, 
-                          float nms_threshold) 
-    : CONFIDENCE_THRESHOLD(conf_threshold)
-    , NMS_THRESHOLD(nms_threshold) {
-    try {
-        net = cv::dnn::readNet(model_path);
-        setBestRuntime(net);
-    } catch (const cv::Exception& e) {
-        throw std::runtime_error("Failed to load network: " + std::string(e.what()));
-    }
+                          float nms_threshold,
+                          PreprocessMode preprocess_mode,
+                          const InferenceOptions& inference)
+    : backend(InferenceBackend::create(model_path, inference))
+    , PREPROCESS_MODE(preprocess_mode)
+    , decoder(conf_threshold)
+    , nms(nmsOptions(conf_threshold, nms_threshold))
+    , tiling(inference.tiling) {
+    candidates.reserve(CANDIDATE_CAPACITY);
+
+    const int blob_size[] = {1, 3, INPUT_HEIGHT, INPUT_WIDTH};
+    input_blob.create(4, blob_size, CV_32F);
+    input_transforms.reserve(4);
+}
+
+double YoloDetector::warmUp() {
+    const auto start = Clock::now();
+    const int blob_size[] = {1, 3, INPUT_HEIGHT, INPUT_WIDTH};
+    input_blob.create(4, blob_size, CV_32F);
+    input_blob.setTo(LETTERBOX_FILL);
+    backend->infer(input_blob, outputs);
+
+    // sizes the decode and NMS buffers as well
+    candidates.clear();
+    decoder.decode(outputPlane(0), BoxTransform{}, candidates);
+    suppress(candidates);
+
+    const double elapsed_ms = millisBetween(start, Clock::now());
+    std::cout << "Warm-up pass: " << elapsed_ms << " ms" << std::endl;
+    return elapsed_ms;
 }
 
-void YoloDetector::setBestRuntime(cv::dnn::Net& net) {
-    if (checkCudaSupport()) {
-        std::cout << "Utilizing CUDA Runtime" << std::endl;
-        net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
-        net.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
-    } else if (checkOpenCLsupport()) {
-        // todo: check if working properly
-        std::cout << "No CUDA device found, fallback to OpenCL" << std::endl;
-        net.setPreferableBackend(cv::dnn::DNN_BACKEND_DEFAULT);
-        net.setPreferableTarget(cv::dnn::DNN_TARGET_OPENCL);
+// resizes (aspect-preserving in letterbox mode) into a reusable scratch image, then does the
+// BGR->RGB swap, 1/255 scaling, padding and HWC->CHW split in one pass over the output plane
+BoxTransform YoloDetector::fillInputPlane(const cv::Mat& input_image, float* plane) {
+    CV_Assert(input_image.type() == CV_8UC3);
+
+    int content_w = INPUT_WIDTH;
+    int content_h = INPUT_HEIGHT;
+    int pad_x = 0;
+    int pad_y = 0;
+    BoxTransform transform;
+
+    if (PREPROCESS_MODE == PreprocessMode::Letterbox) {
+        float ratio = std::min(static_cast<float>(INPUT_WIDTH) / input_image.cols,
+                               static_cast<float>(INPUT_HEIGHT) / input_image.rows);
+        content_w = std::min(INPUT_WIDTH, static_cast<int>(std::round(input_image.cols * ratio)));
+        content_h = std::min(INPUT_HEIGHT, static_cast<int>(std::round(input_image.rows * ratio)));
+        pad_x = (INPUT_WIDTH - content_w) / 2;
+        pad_y = (INPUT_HEIGHT - content_h) / 2;
+
+        transform.scale_x = 1.0f / ratio;
+        transform.scale_y = 1.0f / ratio;
+        transform.offset_x = -pad_x / ratio;
+        transform.offset_y = -pad_y / ratio;
     } else {
-        std::cout << "No CUDA / OpenCL device found, fallback to raw CPU" << std::endl;
+        transform.scale_x = static_cast<float>(input_image.cols) / INPUT_WIDTH;
+        transform.scale_y = static_cast<float>(input_image.rows) / INPUT_HEIGHT;
     }
+
+    const cv::Mat* source = &input_image;
+    if (input_image.cols != content_w || input_image.rows != content_h) {
+        cv::resize(input_image, resized, cv::Size(content_w, content_h), 0, 0, cv::INTER_LINEAR);
+        source = &resized;
+    }
+
+    const size_t plane_size = static_cast<size_t>(INPUT_WIDTH) * INPUT_HEIGHT;
+    float* r_plane = plane;
+    float* g_plane = plane + plane_size;
+    float* b_plane = plane + 2 * plane_size;
+    const cv::Mat& src = *source;
+
+    cv::parallel_for_(cv::Range(0, INPUT_HEIGHT), [&](const cv::Range& rows) {
+        constexpr float SCALE = 1.0f / 255.0f;
+        for (int y = rows.start; y < rows.end; ++y) {
+            const size_t offset = static_cast<size_t>(y) * INPUT_WIDTH;
+            float* r = r_plane + offset;
+            float* g = g_plane + offset;
+            float* b = b_plane + offset;
+
+            const int src_y = y - pad_y;
+            if (src_y < 0 || src_y >= content_h) {
+                std::fill_n(r, INPUT_WIDTH, LETTERBOX_FILL);
+                std::fill_n(g, INPUT_WIDTH, LETTERBOX_FILL);
+                std::fill_n(b, INPUT_WIDTH, LETTERBOX_FILL);
+                continue;
+            }
+
+            const uchar* pixel = src.ptr<uchar>(src_y);
+            for (int x = 0; x < INPUT_WIDTH; ++x) {
+                const int src_x = x - pad_x;
+                if (src_x < 0 || src_x >= content_w) {
+                    r[x] = g[x] = b[x] = LETTERBOX_FILL;
+                    continue;
+                }
+                const uchar* bgr = pixel + 3 * src_x;
+                b[x] = bgr[0] * SCALE;
+                g[x] = bgr[1] * SCALE;
+                r[x] = bgr[2] * SCALE;
+            }
+        }
+    });
+
+    return transform;
 }
 
+void YoloDetector::preProcess(const cv::Mat* input_images, size_t count) {
+    const int blob_size[] = {static_cast<int>(count), 3, INPUT_HEIGHT, INPUT_WIDTH};
+    input_blob.create(4, blob_size, CV_32F);
+
+    input_transforms.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        input_transforms[i] = fillInputPlane(input_images[i], input_blob.ptr<float>(static_cast<int>(i)));
+    }
+}
 
-cv::Mat YoloDetector::preProcess(const cv::Mat& input_image) {
-    cv::Mat blob;
-    cv::dnn::blobFromImage(input_image, blob, 1./255., 
-                          cv::Size(INPUT_WIDTH, INPUT_HEIGHT), 
-                          cv::Scalar(), true, false);
-    net.setInput(blob);
-    return blob;
+// (batch, 4 + classes, anchors) output -> header over one image's (4 + classes, anchors) plane
+cv::Mat YoloDetector::outputPlane(size_t batch_index) const {
+    const cv::Mat& output = outputs[0];
+    const int plane_size[] = {output.size[output.dims - 2], output.size[output.dims - 1]};
+    const size_t plane_elems = static_cast<size_t>(plane_size[0]) * plane_size[1];
+    return cv::Mat(2, plane_size, CV_32F,
+                   const_cast<float*>(output.ptr<float>()) + batch_index * plane_elems);
 }
 
 std::vector<YoloDetector::Detection> YoloDetector::detect(const cv::Mat& input_image) {
-    cv::Mat blob = preProcess(input_image);
-    std::vector<cv::Mat> outputs;
-    net.forward(outputs, net.getUnconnectedOutLayersNames());
-    
-    return postProcess(input_image, outputs[0]);
+    if (needsTiles(input_image.size())) return detectTiled(input_image);
+
+    const auto start = Clock::now();
+    preProcess(&input_image, 1);
+    const auto preprocessed = Clock::now();
+    backend->infer(input_blob, outputs);
+    const auto inferred = Clock::now();
+
+    std::vector<Detection> detections = postProcess(input_image, outputs[0], input_transforms[0]);
+
+    last_timings.preprocess_ms = millisBetween(start, preprocessed);
+    last_timings.inference_ms = millisBetween(preprocessed, inferred);
+    last_timings.postprocess_ms = millisBetween(inferred, Clock::now());
+    recordStageMetrics(last_timings);
+    return detections;
 }
 
-std::vector<YoloDetector::Detection> YoloDetector::postProcess(
-    const cv::Mat& input_image, const cv::Mat& output) {
-    
-    cv::Mat reshaped_output = output.reshape(1, 84);
-    cv::Mat transposed_output;
-    cv::transpose(reshaped_output, transposed_output);
-
-    cv::Mat boxes = transposed_output.colRange(0, 4);
-    cv::Mat scores = transposed_output.colRange(4, transposed_output.cols);
-
-    std::vector<cv::Point2f> points;
-    std::vector<int> class_ids;
-    std::vector<float> confidences;
-
-    for (int i = 0; i < scores.rows; ++i) {
-        cv::Mat scores_row = scores.row(i);
-        cv::Point class_id_point;
-        double confidence;
-        cv::minMaxLoc(scores_row, nullptr, &confidence, nullptr, &class_id_point);
-
-        if (confidence > CONFIDENCE_THRESHOLD) {
-            cv::Mat box = boxes.row(i);
-            float x = box.at<float>(0);
-            float y = box.at<float>(1);
-            float w = box.at<float>(2);
-            float h = box.at<float>(3);
-
-            float x1 = (x - w/2) * input_image.cols / INPUT_WIDTH;
-            float y1 = (y - h/2) * input_image.rows / INPUT_HEIGHT;
-            float x2 = (x + w/2) * input_image.cols / INPUT_WIDTH;
-            float y2 = (y + h/2) * input_image.rows / INPUT_HEIGHT;
-
-            points.push_back(cv::Point2f(x1, y1));
-            points.push_back(cv::Point2f(x2, y2));
-            class_ids.push_back(class_id_point.x);
-            confidences.push_back(static_cast<float>(confidence));
-        }
+std::vector<std::vector<YoloDetector::Detection>> YoloDetector::detectBatch(
+    const std::vector<cv::Mat>& input_images) {
+
+    std::vector<std::vector<Detection>> results(input_images.size());
+    if (input_images.empty()) return results;
+
+    // a tiled frame is a batch of its own
+    if (std::any_of(input_images.begin(), input_images.end(),
+                    [this](const cv::Mat& image) { return needsTiles(image.size()); })) {
+        for (size_t i = 0; i < input_images.size(); ++i) results[i] = detect(input_images[i]);
+        return results;
     }
 
-    std::vector<int> indices;
-    std::vector<cv::Rect2d> boxes_nms;
-    for (size_t i = 0; i < points.size(); i += 2) {
-        boxes_nms.push_back(cv::Rect2d(
-            points[i].x, points[i].y,
-            points[i+1].x - points[i].x,
-            points[i+1].y - points[i].y
-        ));
+    const auto start = Clock::now();
+    preProcess(input_images.data(), input_images.size());
+    const auto preprocessed = Clock::now();
+    backend->infer(input_blob, outputs);
+    const auto inferred = Clock::now();
+
+    for (size_t i = 0; i < input_images.size(); ++i) {
+        results[i] = postProcess(input_images[i], outputPlane(i), input_transforms[i]);
     }
 
-    cv::dnn::NMSBoxes(boxes_nms, confidences, CONFIDENCE_THRESHOLD, 
-                      NMS_THRESHOLD, indices);
+    last_timings.preprocess_ms = millisBetween(start, preprocessed);
+    last_timings.inference_ms = millisBetween(preprocessed, inferred);
+    last_timings.postprocess_ms = millisBetween(inferred, Clock::now());
+    recordStageMetrics(last_timings);
+    return results;
+}
+
+std::vector<YoloDetector::Detection> YoloDetector::postProcess(
+    const cv::Mat& input_image, const cv::Mat& output, const BoxTransform& transform) {
+
+    candidates.clear();
+    decoder.decode(output, transform, candidates);
+
+    suppress(candidates);
+    return collect(candidates, input_image.size());
+}
+
+void YoloDetector::suppress(const DetectionCandidates& boxes) {
+    nms.run(boxes, nms_indices, nms_scores);
+}
 
+std::vector<YoloDetector::Detection> YoloDetector::collect(const DetectionCandidates& boxes,
+                                                           cv::Size image_size) const {
     std::vector<Detection> detections;
-    for (int idx : indices) {
+    detections.reserve(nms_indices.size());
+    const float max_x = static_cast<float>(image_size.width);
+    const float max_y = static_cast<float>(image_size.height);
+    for (size_t k = 0; k < nms_indices.size(); ++k) {
+        const int idx = nms_indices[k];
         Detection det;
-        det.x1 = points[idx*2].x;
-        det.y1 = points[idx*2].y;
-        det.x2 = points[idx*2+1].x;
-        det.y2 = points[idx*2+1].y;
-        det.confidence = confidences[idx];
-        det.class_id = class_ids[idx];
+        det.x1 = std::clamp(boxes.x1[idx], 0.0f, max_x);
+        det.y1 = std::clamp(boxes.y1[idx], 0.0f, max_y);
+        det.x2 = std::clamp(boxes.x2[idx], 0.0f, max_x);
+        det.y2 = std::clamp(boxes.y2[idx], 0.0f, max_y);
+        det.confidence = nms_scores[k];
+        det.class_id = boxes.class_id[idx];
         detections.push_back(det);
     }
 
     return detections;
-}
\ No newline at end of file
+}
+
+bool YoloDetector::needsTiles(cv::Size image_size) const {
+    return tiling.enabled && (image_size.width > tiling.tile_size || image_size.height > tiling.tile_size);
+}
+
+const TileLayout& YoloDetector::tileLayout(cv::Size image_size) {
+    for (const auto& layout : tile_layouts) {
+        if (layout.frame_size == image_size) return layout;
+    }
+    tile_layouts.push_back(TileLayout::compute(image_size, tiling.tile_size, tiling.overlap));
+    return tile_layouts.back();
+}
+
+// runs views through the network, all of them as one batch while the model accepts that, and
+// hands every view's output plane with its transform to decode(view, output, transform)
+template<typename Decode>
+void YoloDetector::forwardViews(const std::vector<cv::Mat>& views, Decode&& decode) {
+    size_t first = 0;
+    while (first < views.size()) {
+        const size_t count = view_batching ? views.size() - first : 1;
+
+        const auto start = Clock::now();
+        preProcess(views.data() + first, count);
+        const auto preprocessed = Clock::now();
+        last_timings.preprocess_ms += millisBetween(start, preprocessed);
+        try {
+            backend->infer(input_blob, outputs);
+        } catch (const std::exception& e) {
+            if (count == 1) throw;
+            // static-batch exports reject N > 1, fall back to one view per forward pass
+            std::cerr << "Batched view inference unavailable, running views one by one: " << e.what() << std::endl;
+            view_batching = false;
+            continue;
+        }
+        const auto inferred = Clock::now();
+        last_timings.inference_ms += millisBetween(preprocessed, inferred);
+
+        for (size_t i = 0; i < count; ++i) decode(first + i, outputPlane(i), input_transforms[i]);
+        last_timings.postprocess_ms += millisBetween(inferred, Clock::now());
+        first += count;
+    }
+}
+
+std::vector<YoloDetector::Detection> YoloDetector::detectTiled(const cv::Mat& input_image) {
+    const TileLayout& layout = tileLayout(input_image.size());
+    tile_views.clear();
+    for (const cv::Rect& tile : layout.tiles) tile_views.push_back(input_image(tile));
+    if (tiling.full_frame_view) tile_views.push_back(input_image);
+
+    last_timings = {};
+    merged.clear();
+    merged_tile.clear();
+
+    // each view's own NMS survivors go to merged in frame coordinates, which keeps the
+    // cross-tile work proportional to objects, not anchors
+    forwardViews(tile_views, [&](size_t view, const cv::Mat& output, BoxTransform transform) {
+        const bool is_tile = view < layout.tiles.size();
+        if (is_tile) {
+            transform.offset_x += layout.tiles[view].x;
+            transform.offset_y += layout.tiles[view].y;
+        }
+
+        candidates.clear();
+        decoder.decode(output, transform, candidates);
+        suppress(candidates);
+        for (int idx : nms_indices) {
+            merged.push(candidates.x1[idx], candidates.y1[idx], candidates.x2[idx], candidates.y2[idx],
+                        candidates.score[idx], candidates.class_id[idx]);
+            merged_tile.push_back(is_tile ? static_cast<int>(view) : -1);
+        }
+    });
+
+    const auto start = Clock::now();
+    fuseTileSeams(layout);
+    suppress(merged);
+    std::vector<Detection> detections = collect(merged, input_image.size());
+    last_timings.postprocess_ms += millisBetween(start, Clock::now());
+
+    recordStageMetrics(last_timings);
+    return detections;
+}
+
+std::vector<YoloDetector::Detection> YoloDetector::detectRegions(const cv::Mat& input_image,
+                                                                 const std::vector<cv::Rect>& regions) {
+    constexpr int CELL_WIDTH = INPUT_WIDTH / MOSAIC_GRID;
+    constexpr int CELL_HEIGHT = INPUT_HEIGHT / MOSAIC_GRID;
+    constexpr size_t CELLS_PER_MOSAIC = MOSAIC_GRID * MOSAIC_GRID;
+
+    last_timings = {};
+    const auto start = Clock::now();
+
+    // every region letterboxed into its own cell, the rest of the mosaic stays padding
+    const cv::Rect frame_rect(0, 0, input_image.cols, input_image.rows);
+    mosaic_cells.clear();
+    for (const cv::Rect& requested : regions) {
+        const cv::Rect region = requested & frame_rect;
+        if (region.empty()) continue;
+
+        MosaicCell cell;
+        cell.region = region;
+        cell.scale = std::min(static_cast<float>(CELL_WIDTH) / region.width,
+                              static_cast<float>(CELL_HEIGHT) / region.height);
+        const size_t slot = mosaic_cells.size() % CELLS_PER_MOSAIC;
+        const int content_w = std::min(CELL_WIDTH, static_cast<int>(std::round(region.width * cell.scale)));
+        const int content_h = std::min(CELL_HEIGHT, static_cast<int>(std::round(region.height * cell.scale)));
+        cell.content = cv::Rect(static_cast<int>(slot % MOSAIC_GRID) * CELL_WIDTH + (CELL_WIDTH - content_w) / 2,
+                                static_cast<int>(slot / MOSAIC_GRID) * CELL_HEIGHT + (CELL_HEIGHT - content_h) / 2,
+                                content_w, content_h);
+        mosaic_cells.push_back(cell);
+    }
+    if (mosaic_cells.empty()) return {};
+
+    const size_t mosaic_count = (mosaic_cells.size() + CELLS_PER_MOSAIC - 1) / CELLS_PER_MOSAIC;
+    mosaics.resize(mosaic_count);
+    for (size_t m = 0; m < mosaic_count; ++m) {
+        mosaics[m].create(INPUT_HEIGHT, INPUT_WIDTH, CV_8UC3);
+        mosaics[m].setTo(cv::Scalar::all(114));
+    }
+    for (size_t c = 0; c < mosaic_cells.size(); ++c) {
+        const MosaicCell& cell = mosaic_cells[c];
+        // the destination is a view into the mosaic with the exact target size, resize writes in place
+        cv::Mat destination = mosaics[c / CELLS_PER_MOSAIC](cell.content);
+        cv::resize(input_image(cell.region), destination, cell.content.size(), 0, 0,
+                   cell.scale < 1.0f ? cv::INTER_AREA : cv::INTER_LINEAR);
+    }
+    last_timings.preprocess_ms += millisBetween(start, Clock::now());
+
+    merged.clear();
+    forwardViews(mosaics, [&](size_t mosaic, const cv::Mat& output, const BoxTransform& transform) {
+        candidates.clear();
+        decoder.decode(output, transform, candidates);
+
+        // a box belongs to the cell holding its center; parts reaching into a neighbour are cut off
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            const float center_x = 0.5f * (candidates.x1[i] + candidates.x2[i]);
+            const float center_y = 0.5f * (candidates.y1[i] + candidates.y2[i]);
+            const int col = std::clamp(static_cast<int>(center_x) / CELL_WIDTH, 0, MOSAIC_GRID - 1);
+            const int row = std::clamp(static_cast<int>(center_y) / CELL_HEIGHT, 0, MOSAIC_GRID - 1);
+            const size_t c = mosaic * CELLS_PER_MOSAIC + row * MOSAIC_GRID + col;
+            if (c >= mosaic_cells.size()) continue;
+
+            const MosaicCell& cell = mosaic_cells[c];
+            const float x1 = std::max(candidates.x1[i], static_cast<float>(cell.content.x));
+            const float y1 = std::max(candidates.y1[i], static_cast<float>(cell.content.y));
+            const float x2 = std::min(candidates.x2[i], static_cast<float>(cell.content.br().x));
+            const float y2 = std::min(candidates.y2[i], static_cast<float>(cell.content.br().y));
+            if (x2 <= x1 || y2 <= y1) continue;
+
+            merged.push(cell.region.x + (x1 - cell.content.x) / cell.scale,
+                        cell.region.y + (y1 - cell.content.y) / cell.scale,
+                        cell.region.x + (x2 - cell.content.x) / cell.scale,
+                        cell.region.y + (y2 - cell.content.y) / cell.scale,
+                        candidates.score[i], candidates.class_id[i]);
+        }
+    });
+
+    const auto nms_start = Clock::now();
+    suppress(merged);
+    std::vector<Detection> detections = collect(merged, input_image.size());
+    last_timings.postprocess_ms += millisBetween(nms_start, Clock::now());
+
+    recordStageMetrics(last_timings);
+    return detections;
+}
+
+// an object cut by a tile border shows up as one partial box on each side of it. boxes of one
+// class from different tiles that are both cut, overlap, and line up along the border are
+// replaced by their union; the absorbed box gets score 0 and falls out in the final NMS
+void YoloDetector::fuseTileSeams(const TileLayout& layout) {
+    constexpr float EDGE_MARGIN = 4.0f;         // px from a tile border that still counts as cut
+    constexpr float MIN_ALIGNMENT = 0.6f;       // shared extent along the border, of the shorter box
+
+    auto cutAxes = [&](size_t box, bool& cut_x, bool& cut_y) {
+        const int tile = merged_tile[box];
+        const cv::Rect& rect = layout.tiles[tile];
+        cut_x = (layout.interiorLeft(tile) && merged.x1[box] <= rect.x + EDGE_MARGIN) ||
+                (layout.interiorRight(tile) && merged.x2[box] >= rect.br().x - EDGE_MARGIN);
+        cut_y = (layout.interiorTop(tile) && merged.y1[box] <= rect.y + EDGE_MARGIN) ||
+                (layout.interiorBottom(tile) && merged.y2[box] >= rect.br().y - EDGE_MARGIN);
+    };
+
+    for (size_t a = 0; a < merged.size(); ++a) {
+        if (merged_tile[a] < 0 || merged.score[a] <= 0.0f) continue;
+        bool a_cut_x, a_cut_y;
+        cutAxes(a, a_cut_x, a_cut_y);
+        if (!a_cut_x && !a_cut_y) continue;
+
+        for (size_t b = 0; b < merged.size(); ++b) {
+            if (b == a || merged_tile[b] < 0 || merged_tile[b] == merged_tile[a] ||
+                merged.score[b] <= 0.0f || merged.class_id[b] != merged.class_id[a]) continue;
+
+            const float overlap_x = std::min(merged.x2[a], merged.x2[b]) - std::max(merged.x1[a], merged.x1[b]);
+            const float overlap_y = std::min(merged.y2[a], merged.y2[b]) - std::max(merged.y1[a], merged.y1[b]);
+            if (overlap_x <= 0.0f || overlap_y <= 0.0f) continue;
+
+            bool b_cut_x, b_cut_y;
+            cutAxes(b, b_cut_x, b_cut_y);
+            const float min_w = std::min(merged.x2[a] - merged.x1[a], merged.x2[b] - merged.x1[b]);
+            const float min_h = std::min(merged.y2[a] - merged.y1[a], merged.y2[b] - merged.y1[b]);
+
+            // cut by a vertical border: the halves share their rows; by a horizontal one, their columns
+            const bool joins = (a_cut_x && b_cut_x && overlap_y >= MIN_ALIGNMENT * min_h) ||
+                               (a_cut_y && b_cut_y && overlap_x >= MIN_ALIGNMENT * min_w);
+            if (!joins) continue;
+
+            merged.x1[a] = std::min(merged.x1[a], merged.x1[b]);
+            merged.y1[a] = std::min(merged.y1[a], merged.y1[b]);
+            merged.x2[a] = std::max(merged.x2[a], merged.x2[b]);
+            merged.y2[a] = std::max(merged.y2[a], merged.y2[b]);
+            merged.score[a] = std::max(merged.score[a], merged.score[b]);
+            merged.score[b] = 0.0f;
+        }
+    }
+}
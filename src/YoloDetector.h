@@ -1,9 +1,11 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
-#include <opencv2/dnn.hpp>
-#include <opencv2/core/ocl.hpp>
+#include <memory>
 #include <vector>
+#include "InferenceBackend.h"
+#include "NonMaxSuppressor.h"
+#include "YoloDecoder.h"
 
 class YoloDetector {
 public:
@@ -13,20 +15,100 @@ public:
         int class_id;
     };
 
+    enum class PreprocessMode {
+        Stretch,    // resize to the network input, ignoring aspect ratio
+        Letterbox   // keep aspect ratio, pad the remainder
+    };
+
     explicit YoloDetector(const std::string& model_path,
                  float conf_threshold = 0.4, 
-                 float nms_threshold = 0.4);
+                 float nms_threshold = 0.4,
+                 PreprocessMode preprocess_mode = PreprocessMode::Letterbox,
+                 const InferenceOptions& inference = {});
 
     std::vector<Detection> detect(const cv::Mat& input_image);
 
+    // packs all frames into one NCHW blob and runs a single forward pass
+    // (the model must be exported with a dynamic batch dimension for more than one frame)
+    std::vector<std::vector<Detection>> detectBatch(const std::vector<cv::Mat>& input_images);
+
+    // with tiling enabled, frames larger than a tile are cut into overlapping tiles (plus a
+    // downscaled view of the whole frame) that run as one batch; boxes cut by a tile border are
+    // fused across it before the final NMS, so small objects in 4K frames keep their pixels
+    std::vector<Detection> detectTiled(const cv::Mat& input_image);
+    void setTiling(const TilingOptions& options) { tiling = options; }
+
+    // class-aware by default; the thresholds come from the constructor unless overridden here
+    void setNms(const NmsOptions& options) { nms.setOptions(options); }
+
+    // detects only inside the given frame regions, e.g. around known tracks: every region is
+    // letterboxed into one cell of a 2x2 mosaic at half the input size, so four crops share one
+    // forward pass and the mosaics of many regions run as one batch. boxes are in frame coordinates
+    std::vector<Detection> detectRegions(const cv::Mat& input_image, const std::vector<cv::Rect>& regions);
+
+    // wall time of each stage of the last detect() / detectBatch() call
+    struct StageTimings {
+        double preprocess_ms = 0.0;
+        double inference_ms = 0.0;
+        double postprocess_ms = 0.0;    // decode + NMS, summed over the batch
+    };
+    const StageTimings& lastTimings() const { return last_timings; }
+
+    std::string describeBackend() const { return backend->describe(); }
+
+    // one forward pass on a blank input, so the first real frame doesn't pay for lazy backend
+    // setup (CUDA kernels, OpenCL programs, memory arenas). returns its wall time in ms
+    double warmUp();
+
 private:
-    cv::dnn::Net net;
-    const float CONFIDENCE_THRESHOLD;
-    const float NMS_THRESHOLD;
+    std::unique_ptr<InferenceBackend> backend;
     static constexpr int INPUT_WIDTH = 640;
     static constexpr int INPUT_HEIGHT = 640;
+    static constexpr size_t CANDIDATE_CAPACITY = 8400;
+    static constexpr float LETTERBOX_FILL = 114.0f / 255.0f;
+
+    const PreprocessMode PREPROCESS_MODE;
+    cv::Mat input_blob;
+    cv::Mat resized;
+    std::vector<BoxTransform> input_transforms;
+    std::vector<cv::Mat> outputs;
+
+    YoloDecoder decoder;
+    DetectionCandidates candidates;
+    NonMaxSuppressor nms;
+    std::vector<int> nms_indices;
+    std::vector<float> nms_scores;
+    StageTimings last_timings;
+
+    TilingOptions tiling;
+    std::vector<TileLayout> tile_layouts;   // one per frame size seen
+    std::vector<cv::Mat> tile_views;        // ROI headers into the frame, no copies
+    DetectionCandidates merged;             // boxes of all tiles or mosaics of a frame, in frame coordinates
+    std::vector<int> merged_tile;           // tile of each merged box, -1 for the full-frame view
+    bool view_batching = true;              // off once a static-batch model rejected a batch of views
+
+    struct MosaicCell {
+        cv::Rect region;        // in the frame
+        cv::Rect content;       // where the scaled region sits in its mosaic
+        float scale = 1.0f;
+    };
+    static constexpr int MOSAIC_GRID = 2;
+    std::vector<cv::Mat> mosaics;
+    std::vector<MosaicCell> mosaic_cells;   // cell i lives in mosaic i / 4
+
+    BoxTransform fillInputPlane(const cv::Mat& input_image, float* plane);
+    void preProcess(const cv::Mat* input_images, size_t count);
+    cv::Mat outputPlane(size_t batch_index) const;
+    std::vector<Detection> postProcess(const cv::Mat& input_image, const cv::Mat& output,
+                                       const BoxTransform& transform);
+
+    // NMS over boxes into nms_indices / nms_scores, then the survivors clamped to the image
+    void suppress(const DetectionCandidates& boxes);
+    std::vector<Detection> collect(const DetectionCandidates& boxes, cv::Size image_size) const;
 
-    void setBestRuntime(cv::dnn::Net& net);
-    cv::Mat preProcess(const cv::Mat& input_image);
-    std::vector<Detection> postProcess(const cv::Mat& input_image, const cv::Mat& output);
+    bool needsTiles(cv::Size image_size) const;
+    const TileLayout& tileLayout(cv::Size image_size);
+    template<typename Decode>
+    void forwardViews(const std::vector<cv::Mat>& views, Decode&& decode);
+    void fuseTileSeams(const TileLayout& layout);
 };
\ No newline at end of file
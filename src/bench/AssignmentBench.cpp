@@ -0,0 +1,90 @@
+// greedy vs optimal (dense and epipolar-banded) stereo assignment on synthetic crowds: time per
+// matchTracks call and how many returned pairs are the true correspondence
+#include "../StereoMatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+namespace {
+    constexpr float IMAGE_WIDTH = 640.0f;
+    constexpr float IMAGE_HEIGHT = 480.0f;
+    constexpr int RIGHT_ID_OFFSET = 100000;
+
+    void makeScene(int count, std::mt19937& rng,
+                   std::vector<TrackingResult>& left, std::vector<TrackingResult>& right) {
+        std::uniform_real_distribution<float> x_dist(0.0f, IMAGE_WIDTH - 60.0f);
+        std::uniform_real_distribution<float> y_dist(0.0f, IMAGE_HEIGHT - 120.0f);
+        std::uniform_real_distribution<float> size_dist(20.0f, 120.0f);
+        std::uniform_real_distribution<float> disparity_dist(2.0f, 40.0f);
+        std::normal_distribution<float> noise(0.0f, 2.0f);
+        std::uniform_int_distribution<int> class_dist(0, 3);
+        std::bernoulli_distribution visible_in_right(0.9);
+
+        left.clear();
+        right.clear();
+        for (int i = 0; i < count; i++) {
+            float x = x_dist(rng), y = y_dist(rng);
+            float w = size_dist(rng) * 0.5f, h = size_dist(rng);
+            int cls = class_dist(rng);
+            left.push_back({x, y, x + w, y + h, i, cls, 0.9f});
+
+            if (!visible_in_right(rng)) continue;
+            float d = disparity_dist(rng);
+            float dy = noise(rng);
+            right.push_back({x - d + noise(rng), y + dy, x + w - d + noise(rng), y + h + dy,
+                             RIGHT_ID_OFFSET + i, cls, 0.9f});
+        }
+        std::shuffle(right.begin(), right.end(), rng);
+    }
+
+    struct Result {
+        double micros = 0.0;
+        double correct = 0.0;
+        double matched = 0.0;
+    };
+
+    Result run(StereoMatcher& matcher, const std::vector<TrackingResult>& left,
+               const std::vector<TrackingResult>& right, int iterations) {
+        Result result;
+        std::vector<StereoPair> pairs;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            pairs = matcher.matchTracks(left, right);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        result.micros = std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+
+        for (const auto& pair : pairs) {
+            if (pair.right_id - RIGHT_ID_OFFSET == pair.left_id) result.correct++;
+        }
+        result.matched = static_cast<double>(pairs.size());
+        return result;
+    }
+}
+
+int main() {
+    std::mt19937 rng(7);
+    StereoMatcher greedy(IMAGE_WIDTH, MatchStrategy::Greedy);
+    StereoMatcher optimal(IMAGE_WIDTH, MatchStrategy::Optimal);
+    StereoMatcher banded(IMAGE_WIDTH, MatchStrategy::Optimal);
+    banded.setEpipolarBand(EpipolarBand{});
+    std::vector<TrackingResult> left, right;
+
+    std::cout << "tracks | greedy us  correct/matched | optimal us  correct/matched"
+                 " | banded us  correct/matched\n";
+    for (int count : {10, 25, 50, 100, 250, 500}) {
+        makeScene(count, rng, left, right);
+        const int iterations = count <= 50 ? 200 : (count <= 100 ? 50 : 5);
+
+        Result g = run(greedy, left, right, iterations);
+        Result o = run(optimal, left, right, iterations);
+        Result b = run(banded, left, right, iterations);
+
+        std::cout << count << " | "
+                  << g.micros << "  " << g.correct << "/" << g.matched << " | "
+                  << o.micros << "  " << o.correct << "/" << o.matched << " | "
+                  << b.micros << "  " << b.correct << "/" << b.matched << "\n";
+    }
+    return 0;
+}
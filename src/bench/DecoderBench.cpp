@@ -0,0 +1,117 @@
+// compares YoloDecoder against the former transpose + minMaxLoc decode on a synthetic
+// yolov9 output tensor and reports the time per frame of both
+#include "../YoloDecoder.h"
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    constexpr int NUM_CHANNELS = 84;
+    constexpr int NUM_ANCHORS = 8400;
+    constexpr int INPUT_SIZE = 640;
+    constexpr float CONFIDENCE_THRESHOLD = 0.4f;
+    constexpr int ITERATIONS = 200;
+
+    cv::Mat makeSyntheticOutput() {
+        const int sizes[] = {1, NUM_CHANNELS, NUM_ANCHORS};
+        cv::Mat output(3, sizes, CV_32F);
+        cv::Mat plane(NUM_CHANNELS, NUM_ANCHORS, CV_32F, output.ptr<float>());
+
+        cv::RNG rng(42);
+        rng.fill(plane.rowRange(0, 2), cv::RNG::UNIFORM, 0.0f, static_cast<float>(INPUT_SIZE));
+        rng.fill(plane.rowRange(2, 4), cv::RNG::UNIFORM, 4.0f, 200.0f);
+        rng.fill(plane.rowRange(4, NUM_CHANNELS), cv::RNG::UNIFORM, 0.0f, 0.05f);
+
+        // a few hundred confident anchors, like a busy frame
+        for (int i = 0; i < 300; ++i) {
+            int anchor = rng.uniform(0, NUM_ANCHORS);
+            int cls = rng.uniform(0, NUM_CHANNELS - 4);
+            plane.at<float>(4 + cls, anchor) = rng.uniform(0.3f, 1.0f);
+        }
+        return output;
+    }
+
+    // the decode loop YoloDetector::postProcess used before YoloDecoder
+    void legacyDecode(const cv::Mat& output, const cv::Size& image_size, DetectionCandidates& out) {
+        cv::Mat reshaped_output = output.reshape(1, NUM_CHANNELS);
+        cv::Mat transposed_output;
+        cv::transpose(reshaped_output, transposed_output);
+
+        cv::Mat boxes = transposed_output.colRange(0, 4);
+        cv::Mat scores = transposed_output.colRange(4, transposed_output.cols);
+
+        for (int i = 0; i < scores.rows; ++i) {
+            cv::Point class_id_point;
+            double confidence;
+            cv::minMaxLoc(scores.row(i), nullptr, &confidence, nullptr, &class_id_point);
+
+            if (confidence > CONFIDENCE_THRESHOLD) {
+                cv::Mat box = boxes.row(i);
+                float x = box.at<float>(0);
+                float y = box.at<float>(1);
+                float w = box.at<float>(2);
+                float h = box.at<float>(3);
+
+                out.push((x - w/2) * image_size.width / INPUT_SIZE,
+                         (y - h/2) * image_size.height / INPUT_SIZE,
+                         (x + w/2) * image_size.width / INPUT_SIZE,
+                         (y + h/2) * image_size.height / INPUT_SIZE,
+                         static_cast<float>(confidence),
+                         class_id_point.x);
+            }
+        }
+    }
+
+    bool sameCandidates(const DetectionCandidates& a, const DetectionCandidates& b) {
+        if (a.size() != b.size()) return false;
+        constexpr float TOLERANCE = 1e-3f;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a.class_id[i] != b.class_id[i] || a.score[i] != b.score[i]) return false;
+            if (std::abs(a.x1[i] - b.x1[i]) > TOLERANCE || std::abs(a.y1[i] - b.y1[i]) > TOLERANCE ||
+                std::abs(a.x2[i] - b.x2[i]) > TOLERANCE || std::abs(a.y2[i] - b.y2[i]) > TOLERANCE) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<typename Fn>
+    double microsPerCall(Fn&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; ++i) fn();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::micro>(elapsed).count() / ITERATIONS;
+    }
+}
+
+int main() {
+    const cv::Size image_size(1280, 720);
+    cv::Mat output = makeSyntheticOutput();
+
+    BoxTransform transform;
+    transform.scale_x = static_cast<float>(image_size.width) / INPUT_SIZE;
+    transform.scale_y = static_cast<float>(image_size.height) / INPUT_SIZE;
+
+    YoloDecoder decoder(CONFIDENCE_THRESHOLD);
+    DetectionCandidates legacy, decoded;
+    decoded.reserve(NUM_ANCHORS);
+
+    legacyDecode(output, image_size, legacy);
+    decoder.decode(output, transform, decoded);
+
+    if (!sameCandidates(legacy, decoded)) {
+        std::cerr << "mismatch: legacy " << legacy.size() << " candidates, decoder "
+                  << decoded.size() << std::endl;
+        return 1;
+    }
+
+    double legacy_us = microsPerCall([&] { legacy.clear(); legacyDecode(output, image_size, legacy); });
+    double decoder_us = microsPerCall([&] { decoded.clear(); decoder.decode(output, transform, decoded); });
+
+    std::cout << "candidates: " << decoded.size() << " (outputs match)\n"
+              << "legacy decode:  " << legacy_us << " us/frame\n"
+              << "YoloDecoder:    " << decoder_us << " us/frame\n"
+              << "speedup:        " << legacy_us / decoder_us << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,192 @@
+// runs the same model over the same frames on every inference engine and compares the time per
+// frame and how well each engine's detections agree with the first one
+//
+// usage: visionary_engine_bench [--input <video|dir>] [--model <onnx>] [--frames N]
+//                               [--engines opencv,openvino,onnxruntime] [--threads N] [--affinity <cores>]
+#include "../FrameSource.h"
+#include "../YoloDetector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int DEFAULT_FRAMES = 100;
+    constexpr int WARMUP_FRAMES = 5;
+    constexpr float MATCH_IOU = 0.5f;
+
+    struct BenchOptions {
+        std::string input;          // empty: random noise frames
+        std::string model_path = "assets/yolov9-m.onnx";
+        int frames = DEFAULT_FRAMES;
+        std::vector<std::string> engines = {"opencv", "openvino", "onnxruntime"};
+        int threads = 0;
+        std::string thread_affinity;
+    };
+
+    BenchOptions parseOptions(int argc, char** argv) {
+        BenchOptions options;
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            const std::string value = argv[++i];
+            if (arg == "--input") options.input = value;
+            else if (arg == "--model") options.model_path = value;
+            else if (arg == "--frames") options.frames = std::stoi(value);
+            else if (arg == "--threads") options.threads = std::stoi(value);
+            else if (arg == "--affinity") options.thread_affinity = value;
+            else if (arg == "--engines") {
+                options.engines.clear();
+                std::stringstream list(value);
+                std::string engine;
+                while (std::getline(list, engine, ',')) options.engines.push_back(engine);
+            }
+            else throw std::runtime_error("Unknown argument " + arg);
+        }
+        if (options.frames < 1) throw std::runtime_error("--frames must be positive");
+        return options;
+    }
+
+    // decoded up front, so every engine gets identical frames and decoding isn't timed
+    std::vector<cv::Mat> loadFrames(const BenchOptions& options) {
+        std::vector<cv::Mat> frames;
+        if (options.input.empty()) {
+            cv::RNG rng(42);
+            for (int i = 0; i < options.frames; i++) {
+                cv::Mat frame(720, 1280, CV_8UC3);
+                rng.fill(frame, cv::RNG::UNIFORM, 0, 256);
+                frames.push_back(frame);
+            }
+            return frames;
+        }
+
+        FrameSourceOptions source_options;
+        source_options.pacing = Pacing::AsFastAsPossible;
+        auto source = FrameSource::create(options.input, source_options);
+        if (!source->open()) throw std::runtime_error("Could not open " + source->describe());
+
+        cv::Mat frame;
+        int64_t capture_ns = 0;
+        while (static_cast<int>(frames.size()) < options.frames && source->read(frame, capture_ns)) {
+            frames.push_back(frame.clone());
+        }
+        if (frames.empty()) throw std::runtime_error(source->describe() + " has no frames");
+        return frames;
+    }
+
+    struct EngineResult {
+        std::string name;
+        std::string backend;
+        std::vector<double> frame_ms;
+        std::vector<double> inference_ms;
+        std::vector<std::vector<YoloDetector::Detection>> detections;
+    };
+
+    double percentile(std::vector<double> samples, double p) {
+        std::sort(samples.begin(), samples.end());
+        size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    }
+
+    float iou(const YoloDetector::Detection& a, const YoloDetector::Detection& b) {
+        float w = std::min(a.x2, b.x2) - std::max(a.x1, b.x1);
+        float h = std::min(a.y2, b.y2) - std::max(a.y1, b.y1);
+        if (w <= 0.0f || h <= 0.0f) return 0.0f;
+        float inter = w * h;
+        float area_a = (a.x2 - a.x1) * (a.y2 - a.y1);
+        float area_b = (b.x2 - b.x1) * (b.y2 - b.y1);
+        return inter / (area_a + area_b - inter);
+    }
+
+    // share of the reference detections found again by the other engine (same class, IoU >= 0.5)
+    double agreement(const EngineResult& reference, const EngineResult& other) {
+        size_t total = 0, found = 0;
+        for (size_t f = 0; f < reference.detections.size(); f++) {
+            for (const auto& det : reference.detections[f]) {
+                total++;
+                for (const auto& candidate : other.detections[f]) {
+                    if (candidate.class_id == det.class_id && iou(det, candidate) >= MATCH_IOU) {
+                        found++;
+                        break;
+                    }
+                }
+            }
+        }
+        return total == 0 ? 1.0 : static_cast<double>(found) / total;
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    std::vector<cv::Mat> frames;
+    try {
+        options = parseOptions(argc, argv);
+        frames = loadFrames(options);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\nusage: visionary_engine_bench [--input <video|dir>] [--model <onnx>] [--frames N]\n"
+                                 "       [--engines opencv,openvino,onnxruntime] [--threads N] [--affinity <cores>]"
+                  << std::endl;
+        return 2;
+    }
+
+    std::vector<EngineResult> results;
+    for (const std::string& engine : options.engines) {
+        InferenceOptions inference;
+        inference.threads = options.threads;
+        inference.thread_affinity = options.thread_affinity;
+
+        std::unique_ptr<YoloDetector> detector;
+        try {
+            inference.engine = InferenceBackend::parseEngine(engine);
+            detector = std::make_unique<YoloDetector>(options.model_path, 0.4f, 0.4f,
+                                                      YoloDetector::PreprocessMode::Letterbox, inference);
+        } catch (const std::exception& e) {
+            std::cout << engine << ": skipped, " << e.what() << std::endl;
+            continue;
+        }
+
+        for (int i = 0; i < WARMUP_FRAMES; i++) detector->detect(frames[i % frames.size()]);
+
+        EngineResult result;
+        result.name = engine;
+        result.backend = detector->describeBackend();
+        for (const cv::Mat& frame : frames) {
+            auto start = Clock::now();
+            result.detections.push_back(detector->detect(frame));
+            result.frame_ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+            result.inference_ms.push_back(detector->lastTimings().inference_ms);
+        }
+        results.push_back(std::move(result));
+    }
+
+    if (results.empty()) {
+        std::cerr << "No engine could be run" << std::endl;
+        return 1;
+    }
+
+    std::cout << frames.size() << " frames of " << frames[0].cols << "x" << frames[0].rows
+              << (options.input.empty() ? " noise" : " from " + options.input) << "\n\n"
+              << std::left << std::setw(14) << "engine" << std::setw(34) << "backend"
+              << std::right << std::setw(10) << "p50 ms" << std::setw(10) << "p95 ms"
+              << std::setw(14) << "infer p50" << std::setw(10) << "fps" << std::setw(12) << "agreement" << "\n";
+    for (const EngineResult& result : results) {
+        double total_ms = 0.0;
+        for (double ms : result.frame_ms) total_ms += ms;
+
+        std::cout << std::left << std::setw(14) << result.name << std::setw(34) << result.backend
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << percentile(result.frame_ms, 0.50)
+                  << std::setw(10) << percentile(result.frame_ms, 0.95)
+                  << std::setw(14) << percentile(result.inference_ms, 0.50)
+                  << std::setw(10) << 1000.0 * result.frame_ms.size() / total_ms
+                  << std::setw(11) << 100.0 * agreement(results.front(), result) << "%\n";
+    }
+    std::cout << "\nagreement: detections of " << results.front().name
+              << " found again with the same class at IoU >= " << MATCH_IOU << std::endl;
+    return 0;
+}
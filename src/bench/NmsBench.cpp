@@ -0,0 +1,113 @@
+// compares NonMaxSuppressor against cv::dnn::NMSBoxes on crowded synthetic candidates: checks
+// that class-agnostic hard NMS keeps the same boxes, then reports the time per call of each
+// variant from a sparse frame up to all 8400 anchors above threshold
+#include "../NonMaxSuppressor.h"
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+    constexpr float SCORE_THRESHOLD = 0.4f;
+    constexpr float IOU_THRESHOLD = 0.4f;
+    constexpr int NUM_CLASSES = 80;
+    constexpr int ITERATIONS = 50;
+    const int CANDIDATE_COUNTS[] = {100, 1000, 3000, 8400};
+
+    // clusters of jittered boxes around a few hundred objects, like the raw anchors of a crowd
+    DetectionCandidates makeCandidates(int count) {
+        cv::RNG rng(42);
+        const int objects = std::max(1, count / 20);
+        std::vector<cv::Rect2f> centers;
+        std::vector<int> classes;
+        for (int i = 0; i < objects; ++i) {
+            centers.emplace_back(rng.uniform(0.0f, 1200.0f), rng.uniform(0.0f, 640.0f),
+                                 rng.uniform(20.0f, 160.0f), rng.uniform(40.0f, 240.0f));
+            classes.push_back(rng.uniform(0, 4) == 0 ? rng.uniform(0, NUM_CLASSES) : 0);
+        }
+
+        DetectionCandidates candidates;
+        candidates.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            const int object = rng.uniform(0, objects);
+            const cv::Rect2f& box = centers[object];
+            const float x = box.x + rng.gaussian(0.08 * box.width);
+            const float y = box.y + rng.gaussian(0.08 * box.height);
+            const float w = box.width * rng.uniform(0.85f, 1.15f);
+            const float h = box.height * rng.uniform(0.85f, 1.15f);
+            candidates.push(x, y, x + w, y + h, rng.uniform(SCORE_THRESHOLD + 0.001f, 1.0f), classes[object]);
+        }
+        return candidates;
+    }
+
+    void opencvNms(const DetectionCandidates& candidates, std::vector<cv::Rect2d>& boxes, std::vector<int>& keep) {
+        boxes.clear();
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            boxes.emplace_back(candidates.x1[i], candidates.y1[i],
+                               candidates.x2[i] - candidates.x1[i], candidates.y2[i] - candidates.y1[i]);
+        }
+        cv::dnn::NMSBoxes(boxes, candidates.score, SCORE_THRESHOLD, IOU_THRESHOLD, keep);
+    }
+
+    template<typename Fn>
+    double microsPerCall(Fn&& fn) {
+        fn();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ITERATIONS; ++i) fn();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        return std::chrono::duration<double, std::micro>(elapsed).count() / ITERATIONS;
+    }
+}
+
+int main() {
+    NmsOptions agnostic;
+    agnostic.score_threshold = SCORE_THRESHOLD;
+    agnostic.iou_threshold = IOU_THRESHOLD;
+    agnostic.class_aware = false;
+    agnostic.top_k = 0;
+
+    NmsOptions aware = agnostic;
+    aware.class_aware = true;
+    NmsOptions top_k = aware;
+    top_k.top_k = 100;
+    NmsOptions soft = aware;
+    soft.soft = true;
+
+    std::vector<cv::Rect2d> boxes;
+    std::vector<int> opencv_keep, keep;
+    std::vector<float> kept_scores;
+
+    std::cout << std::setw(10) << "candidates" << std::setw(14) << "NMSBoxes us" << std::setw(14) << "agnostic us"
+              << std::setw(14) << "per-class us" << std::setw(12) << "top-100 us" << std::setw(12) << "soft us"
+              << std::setw(8) << "kept" << "\n";
+    for (int count : CANDIDATE_COUNTS) {
+        const DetectionCandidates candidates = makeCandidates(count);
+
+        NonMaxSuppressor suppressor(agnostic);
+        opencvNms(candidates, boxes, opencv_keep);
+        suppressor.run(candidates, keep, kept_scores);
+        if (keep != opencv_keep) {
+            std::cerr << "mismatch at " << count << " candidates: NMSBoxes kept " << opencv_keep.size()
+                      << ", NonMaxSuppressor " << keep.size() << std::endl;
+            return 1;
+        }
+
+        const double opencv_us = microsPerCall([&] { opencvNms(candidates, boxes, opencv_keep); });
+        auto timed = [&](const NmsOptions& options) {
+            suppressor.setOptions(options);
+            return microsPerCall([&] { suppressor.run(candidates, keep, kept_scores); });
+        };
+        const double agnostic_us = timed(agnostic);
+        const double aware_us = timed(aware);
+        const size_t aware_kept = keep.size();
+        const double top_k_us = timed(top_k);
+        const double soft_us = timed(soft);
+
+        std::cout << std::fixed << std::setprecision(1) << std::setw(10) << count << std::setw(14) << opencv_us
+                  << std::setw(14) << agnostic_us << std::setw(14) << aware_us << std::setw(12) << top_k_us
+                  << std::setw(12) << soft_us << std::setw(8) << aware_kept << "\n";
+    }
+    std::cout << "class-agnostic results match NMSBoxes" << std::endl;
+    return 0;
+}
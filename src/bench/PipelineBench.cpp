@@ -0,0 +1,338 @@
+// end-to-end replay of a recorded clip (or synthetic frames) through every stage of the
+// pipeline on one thread: read, preprocess, inference, postprocess + NMS, tracking, stereo
+// matching and rendering. reports per-stage p50/p95/p99 latency, throughput and heap
+// allocations per frame as JSON.
+//
+// usage: visionary_bench [--input <video|dir>] [--model <onnx>] [--frames N] [--warmup N] [--json <file>]
+#include "../FrameSource.h"
+#include "../OCSortTracker.h"
+#include "../OneCamera.h"
+#include "../StereoMatcher.h"
+#include "../YoloDetector.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+
+// every operator new in the process goes through here; the bench reads the counter around each stage
+static std::atomic<uint64_t> heap_allocations{0};
+
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int DEFAULT_FRAMES = 300;
+    constexpr int DEFAULT_WARMUP = 10;
+    constexpr int SYNTHETIC_WIDTH = 1280;
+    constexpr int SYNTHETIC_HEIGHT = 720;
+    constexpr int SYNTHETIC_OBJECTS = 12;
+    constexpr float SYNTHETIC_DISPARITY = 24.0f;    // px shift of the fake right view
+    constexpr int RIGHT_ID_OFFSET = 100000;
+
+    // cv::Mat buffers come from cv::fastMalloc, not operator new; count them through the allocator hook
+    class CountingMatAllocator : public cv::MatAllocator {
+    public:
+        CountingMatAllocator() : inner_(cv::Mat::getStdAllocator()) {}
+
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                               cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+            if (!data) heap_allocations.fetch_add(1, std::memory_order_relaxed);
+            return inner_->allocate(dims, sizes, type, data, step, flags, usage);
+        }
+        bool allocate(cv::UMatData* data, cv::AccessFlag flags, cv::UMatUsageFlags usage) const override {
+            return inner_->allocate(data, flags, usage);
+        }
+        void deallocate(cv::UMatData* data) const override { inner_->deallocate(data); }
+
+    private:
+        cv::MatAllocator* inner_;
+    };
+
+    // colored boxes drifting across a noisy background; exercises the stages, not the model
+    class SyntheticSource : public FrameSource {
+    public:
+        bool open() override {
+            cv::RNG rng(42);
+            for (int i = 0; i < SYNTHETIC_OBJECTS; i++) {
+                objects_.push_back({cv::Rect(rng.uniform(0, SYNTHETIC_WIDTH - 160), rng.uniform(0, SYNTHETIC_HEIGHT - 240),
+                                             rng.uniform(40, 160), rng.uniform(80, 240)),
+                                    cv::Point(rng.uniform(-6, 7), rng.uniform(-3, 4)),
+                                    cv::Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256))});
+            }
+            background_.create(SYNTHETIC_HEIGHT, SYNTHETIC_WIDTH, CV_8UC3);
+            rng.fill(background_, cv::RNG::UNIFORM, 60, 120);
+            return true;
+        }
+
+        bool read(cv::Mat& out, int64_t& capture_ns) override {
+            background_.copyTo(out);
+            for (auto& object : objects_) {
+                object.box += object.velocity;
+                if (object.box.x < 0 || object.box.br().x > SYNTHETIC_WIDTH) object.velocity.x = -object.velocity.x;
+                if (object.box.y < 0 || object.box.br().y > SYNTHETIC_HEIGHT) object.velocity.y = -object.velocity.y;
+                cv::rectangle(out, object.box, object.color, cv::FILLED);
+            }
+            capture_ns = static_cast<int64_t>(frame_index_++ * 1e9 / 30.0);
+            return true;
+        }
+
+        bool isLive() const override { return false; }
+        std::string describe() const override { return "synthetic"; }
+
+    private:
+        struct MovingBox {
+            cv::Rect box;
+            cv::Point velocity;
+            cv::Scalar color;
+        };
+
+        std::vector<MovingBox> objects_;
+        cv::Mat background_;
+        uint64_t frame_index_ = 0;
+    };
+
+    struct BenchOptions {
+        std::string input;          // empty: synthetic frames
+        std::string model_path = "assets/yolov9-m.onnx";
+        std::string json_path;      // empty: stdout
+        int frames = DEFAULT_FRAMES;
+        int warmup = DEFAULT_WARMUP;
+    };
+
+    BenchOptions parseOptions(int argc, char** argv) {
+        BenchOptions options;
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            const std::string value = argv[++i];
+            if (arg == "--input") options.input = value;
+            else if (arg == "--model") options.model_path = value;
+            else if (arg == "--json") options.json_path = value;
+            else if (arg == "--frames") options.frames = std::stoi(value);
+            else if (arg == "--warmup") options.warmup = std::stoi(value);
+            else throw std::runtime_error("Unknown argument " + arg);
+        }
+        if (options.frames < 1 || options.warmup < 0) throw std::runtime_error("--frames must be positive");
+        return options;
+    }
+
+    enum Stage { Read, Preprocess, Inference, Postprocess, Tracking, StereoMatching, Rendering, Total, STAGE_COUNT };
+
+    const char* STAGE_NAMES[STAGE_COUNT] = {
+        "read", "preprocess", "inference", "postprocess", "tracking", "stereo_matching", "rendering", "total"
+    };
+
+    // preprocess, inference and postprocess run inside one detect() call, so their
+    // allocations are only known together and are reported under "detection"
+    enum AllocationGroup { ReadAllocs, DetectionAllocs, TrackingAllocs, MatchingAllocs, RenderingAllocs, GROUP_COUNT };
+
+    const char* GROUP_NAMES[GROUP_COUNT] = {"read", "detection", "tracking", "stereo_matching", "rendering"};
+
+    // nearest-rank percentile of sorted samples
+    double percentile(const std::vector<double>& sorted, double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    // paths end up in the report; windows separators must not break the JSON
+    std::string jsonString(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') quoted += '\\';
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    double millisSince(Clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // the left tracks seen by a second camera SYNTHETIC_DISPARITY px to the right
+    void makeRightView(const std::vector<TrackingResult>& left, std::vector<TrackingResult>& right) {
+        right.clear();
+        for (const auto& track : left) {
+            TrackingResult shifted = track;
+            shifted.x1 -= SYNTHETIC_DISPARITY;
+            shifted.x2 -= SYNTHETIC_DISPARITY;
+            shifted.track_id += RIGHT_ID_OFFSET;
+            right.push_back(shifted);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\nusage: visionary_bench [--input <video|dir>] [--model <onnx>] "
+                                 "[--frames N] [--warmup N] [--json <file>]" << std::endl;
+        return 2;
+    }
+
+    static CountingMatAllocator mat_allocator;
+    cv::Mat::setDefaultAllocator(&mat_allocator);
+
+    FrameSourceOptions source_options;
+    source_options.pacing = Pacing::AsFastAsPossible;
+    std::unique_ptr<FrameSource> source = options.input.empty()
+        ? std::make_unique<SyntheticSource>()
+        : FrameSource::create(options.input, source_options);
+    if (!source->open()) {
+        std::cerr << "Could not open " << source->describe() << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> classes;
+    std::ifstream class_file("assets/coco.names");
+    for (std::string line; std::getline(class_file, line);) classes.push_back(line);
+
+    YoloDetector detector(options.model_path);
+    OCSortTracker tracker;
+    cv::Mat frame;
+    cv::Mat rendered;
+    int64_t capture_ns = 0;
+    std::vector<YoloDetector::Detection> detections;
+    std::vector<TrackingResult> tracks;
+    std::vector<TrackingResult> right_tracks;
+    std::unique_ptr<StereoMatcher> matcher;
+    size_t pair_count = 0;
+
+    std::vector<double> samples[STAGE_COUNT];
+    for (auto& stage : samples) stage.reserve(options.frames);
+    uint64_t allocations[GROUP_COUNT] = {};
+
+    const int total_frames = options.warmup + options.frames;
+    int measured = 0;
+    Clock::time_point measure_start = Clock::now();
+
+    for (int i = 0; i < total_frames; i++) {
+        const bool measuring = i >= options.warmup;
+        if (i == options.warmup) measure_start = Clock::now();
+
+        uint64_t allocs_before = heap_allocations.load(std::memory_order_relaxed);
+        auto frame_start = Clock::now();
+        if (!source->read(frame, capture_ns)) break;
+        double read_ms = millisSince(frame_start);
+        uint64_t read_allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+        allocs_before = heap_allocations.load(std::memory_order_relaxed);
+        detections = detector.detect(frame);
+        uint64_t detection_allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+        allocs_before = heap_allocations.load(std::memory_order_relaxed);
+        auto stage_start = Clock::now();
+        tracker.update(detections, tracks);
+        double tracking_ms = millisSince(stage_start);
+        uint64_t tracking_allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+        // built outside the timed region; the right view stands in for a second camera's tracks
+        if (!matcher) matcher = std::make_unique<StereoMatcher>(static_cast<float>(frame.cols));
+        makeRightView(tracks, right_tracks);
+
+        allocs_before = heap_allocations.load(std::memory_order_relaxed);
+        stage_start = Clock::now();
+        size_t pairs = matcher->matchTracks(tracks, right_tracks).size();
+        double matching_ms = millisSince(stage_start);
+        uint64_t matching_allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+        allocs_before = heap_allocations.load(std::memory_order_relaxed);
+        stage_start = Clock::now();
+        frame.copyTo(rendered);
+        visualize_detections_and_tracks(rendered, detections, tracks, classes);
+        double rendering_ms = millisSince(stage_start);
+        uint64_t rendering_allocs = heap_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+        double total_ms = millisSince(frame_start);
+        if (!measuring) continue;
+
+        const YoloDetector::StageTimings& timings = detector.lastTimings();
+        samples[Read].push_back(read_ms);
+        samples[Preprocess].push_back(timings.preprocess_ms);
+        samples[Inference].push_back(timings.inference_ms);
+        samples[Postprocess].push_back(timings.postprocess_ms);
+        samples[Tracking].push_back(tracking_ms);
+        samples[StereoMatching].push_back(matching_ms);
+        samples[Rendering].push_back(rendering_ms);
+        samples[Total].push_back(total_ms);
+
+        pair_count += pairs;
+        allocations[ReadAllocs] += read_allocs;
+        allocations[DetectionAllocs] += detection_allocs;
+        allocations[TrackingAllocs] += tracking_allocs;
+        allocations[MatchingAllocs] += matching_allocs;
+        allocations[RenderingAllocs] += rendering_allocs;
+        measured++;
+    }
+    const double wall_s = std::chrono::duration<double>(Clock::now() - measure_start).count();
+
+    if (measured == 0) {
+        std::cerr << "No frames measured: " << source->describe() << " ended during warm-up" << std::endl;
+        return 1;
+    }
+
+    std::ofstream json_file;
+    if (!options.json_path.empty()) {
+        json_file.open(options.json_path);
+        if (!json_file) {
+            std::cerr << "Could not write " << options.json_path << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& json = options.json_path.empty() ? std::cout : json_file;
+
+    uint64_t total_allocations = 0;
+    for (uint64_t count : allocations) total_allocations += count;
+
+    json << "{\n"
+         << "  \"input\": " << jsonString(source->describe()) << ",\n"
+         << "  \"model\": " << jsonString(options.model_path) << ",\n"
+         << "  \"frames\": " << measured << ",\n"
+         << "  \"warmup\": " << options.warmup << ",\n"
+         << "  \"resolution\": [" << frame.cols << ", " << frame.rows << "],\n"
+         << "  \"wall_s\": " << wall_s << ",\n"
+         << "  \"throughput_fps\": " << measured / wall_s << ",\n"
+         << "  \"stereo_pairs_per_frame\": " << static_cast<double>(pair_count) / measured << ",\n"
+         << "  \"stages\": {\n";
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        std::vector<double>& sorted = samples[stage];
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double sample : sorted) sum += sample;
+
+        json << "    \"" << STAGE_NAMES[stage] << "\": {"
+             << "\"p50_ms\": " << percentile(sorted, 0.50)
+             << ", \"p95_ms\": " << percentile(sorted, 0.95)
+             << ", \"p99_ms\": " << percentile(sorted, 0.99)
+             << ", \"mean_ms\": " << sum / sorted.size()
+             << ", \"max_ms\": " << sorted.back()
+             << "}" << (stage + 1 < STAGE_COUNT ? "," : "") << "\n";
+    }
+    json << "  },\n"
+         << "  \"allocations_per_frame\": {";
+    for (int group = 0; group < GROUP_COUNT; group++) {
+        json << "\"" << GROUP_NAMES[group] << "\": " << static_cast<double>(allocations[group]) / measured << ", ";
+    }
+    json << "\"total\": " << static_cast<double>(total_allocations) / measured << "}\n"
+         << "}" << std::endl;
+
+    std::cerr << measured << " frames of " << source->describe() << " at " << measured / wall_s
+              << " fps, p99 " << percentile(samples[Total], 0.99) << " ms/frame" << std::endl;
+    return 0;
+}
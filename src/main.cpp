@@ -1,17 +1,46 @@
 #include <iostream>
+#include <memory>
+#include <string>
 #include <opencv2/core/utils/logger.hpp>
 #include "../../oc-sort/deploy/OCSort/cpp/include/OCSort.hpp"
+#include "Metrics.h"
+#include "RunOptions.h"
 #define RUN_PROGRAM2
 
 #ifdef RUN_PROGRAM2
 #include "StereoCamera.h"
+#include "OneCamera.h"
 #endif
 
 
-int main() {
+int main(int argc, char** argv) {
+    markProcessStart();
     cv::utils::logging::setLogLevel(cv::utils::logging::LOG_LEVEL_WARNING);
+
+    RunOptions options;
+    try {
+        options = RunOptions::parse(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n" << RunOptions::usage();
+        return -1;
+    }
+    if (options.resultsOnStdout()) reserveStdoutForResults();
+
+    // written every few seconds and once more when the run ends
+    std::unique_ptr<MetricsExporter> metrics_exporter;
+    if (!options.metrics_path.empty()) {
+        metrics_exporter = std::make_unique<MetricsExporter>(options.metrics_path);
+    }
+
 #ifdef RUN_PROGRAM2
-    stereoCameraProto();
+    switch (options.mode) {
+        case RunOptions::Mode::Multi:
+            return multiCameraProto(options);
+        case RunOptions::Mode::Single:
+            return oneCameraProto(options);
+        case RunOptions::Mode::Stereo:
+            return stereoCameraProto(options);
+    }
 #endif
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,160 @@
+// matches objects seen by a synthetic rectified rig with a known baseline: the rectified boxes must
+// be shifted by f * B / Z, every object must pair with itself under both strategies, with and
+// without the epipolar band, and the band must reject a right track on the wrong side
+#include "../StereoMatcher.h"
+#include "../StereoRectifier.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+    constexpr int IMAGE_WIDTH = 640;
+    constexpr int IMAGE_HEIGHT = 480;
+    constexpr double FOCAL_PX = 600.0;
+    constexpr double BASELINE = 0.12;           // m, right camera to the right of the left one
+    constexpr int OBJECT_COUNT = 8;             // one per image row band, 50 px apart
+    constexpr int SCENES = 20;
+    constexpr int RIGHT_ID_OFFSET = 100000;
+    constexpr float BOX_HALF_WIDTH = 20.0f;
+    constexpr float BOX_HALF_HEIGHT = 30.0f;
+    constexpr float DISPARITY_TOLERANCE = 1.0f; // px, the rectification table is interpolated
+
+    struct Scene {
+        std::vector<TrackingResult> left, right;
+        std::vector<float> depth;               // per left track
+    };
+
+    StereoCalibration makeCalibration() {
+        StereoCalibration calibration;
+        calibration.image_size = cv::Size(IMAGE_WIDTH, IMAGE_HEIGHT);
+        calibration.M1 = (cv::Mat_<double>(3, 3) << FOCAL_PX, 0, IMAGE_WIDTH / 2.0,
+                                                    0, FOCAL_PX, IMAGE_HEIGHT / 2.0,
+                                                    0, 0, 1);
+        calibration.M2 = calibration.M1.clone();
+        calibration.D1 = cv::Mat::zeros(1, 5, CV_64F);
+        calibration.D2 = cv::Mat::zeros(1, 5, CV_64F);
+        calibration.R = cv::Mat::eye(3, 3, CV_64F);
+        // cv::stereoCalibrate convention, X_right = R * X_left + T
+        calibration.T = (cv::Mat_<double>(3, 1) << -BASELINE, 0.0, 0.0);
+        return calibration;
+    }
+
+    TrackingResult boxAround(const cv::Point2f& center, int track_id) {
+        return {center.x - BOX_HALF_WIDTH, center.y - BOX_HALF_HEIGHT,
+                center.x + BOX_HALF_WIDTH, center.y + BOX_HALF_HEIGHT, track_id, 0, 0.9f};
+    }
+
+    float centerX(const TrackingResult& track) {
+        return (track.x1 + track.x2) * 0.5f;
+    }
+
+    // projects random points into both raw views and rectifies the boxes, right side shuffled
+    Scene makeScene(const StereoCalibration& calibration, const StereoRectifier& rectifier, std::mt19937& rng) {
+        std::uniform_real_distribution<float> x_dist(160.0f, 600.0f);
+        std::uniform_real_distribution<float> depth_dist(1.5f, 10.0f);
+
+        Scene scene;
+        std::vector<cv::Point3f> points;
+        for (int i = 0; i < OBJECT_COUNT; i++) {
+            const float u = x_dist(rng);
+            const float v = 50.0f + i * 50.0f;
+            const float z = depth_dist(rng);
+            points.emplace_back((u - IMAGE_WIDTH / 2.0f) * z / static_cast<float>(FOCAL_PX),
+                                (v - IMAGE_HEIGHT / 2.0f) * z / static_cast<float>(FOCAL_PX), z);
+            scene.depth.push_back(z);
+        }
+
+        const cv::Mat no_rotation = cv::Mat::zeros(3, 1, CV_64F);
+        std::vector<cv::Point2f> left_px, right_px;
+        cv::projectPoints(points, no_rotation, cv::Mat::zeros(3, 1, CV_64F),
+                          calibration.M1, calibration.D1, left_px);
+        cv::projectPoints(points, no_rotation, calibration.T, calibration.M2, calibration.D2, right_px);
+
+        for (int i = 0; i < OBJECT_COUNT; i++) {
+            scene.left.push_back(boxAround(left_px[i], i));
+            scene.right.push_back(boxAround(right_px[i], RIGHT_ID_OFFSET + i));
+        }
+        rectifier.rectify(StereoRectifier::Side::Left, scene.left);
+        rectifier.rectify(StereoRectifier::Side::Right, scene.right);
+        std::shuffle(scene.right.begin(), scene.right.end(), rng);
+        return scene;
+    }
+
+    bool checkDisparity(const Scene& scene, const StereoRectifier& rectifier) {
+        // P2 = [f 0 cx Tx*f], so a point at depth Z lands f * B / Z px further left on the right
+        const float shift = static_cast<float>(-rectifier.projectionRight().at<double>(0, 3));
+        for (const auto& left : scene.left) {
+            auto right = std::find_if(scene.right.begin(), scene.right.end(), [&](const TrackingResult& track) {
+                return track.track_id == left.track_id + RIGHT_ID_OFFSET;
+            });
+            const float disparity = centerX(left) - centerX(*right);
+            const float expected = shift / scene.depth[left.track_id];
+            if (std::abs(disparity - expected) > DISPARITY_TOLERANCE) {
+                std::cerr << "object " << left.track_id << ": rectified disparity " << disparity
+                          << " px, expected " << expected << " px" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool checkMatches(const char* name, StereoMatcher& matcher, const Scene& scene) {
+        const std::vector<StereoPair> pairs = matcher.matchTracks(scene.left, scene.right);
+        const auto correct = std::count_if(pairs.begin(), pairs.end(), [](const StereoPair& pair) {
+            return pair.right_id - RIGHT_ID_OFFSET == pair.left_id;
+        });
+        if (correct != OBJECT_COUNT || pairs.size() != static_cast<size_t>(OBJECT_COUNT)) {
+            std::cerr << name << ": " << correct << " of " << OBJECT_COUNT << " objects matched correctly, "
+                      << pairs.size() << " pairs" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // the same box mirrored to the right of its left track can't be a correspondence
+    bool checkWrongSide(StereoMatcher& matcher, const Scene& scene) {
+        const TrackingResult& left = scene.left.front();
+        TrackingResult mirrored = left;
+        mirrored.x1 += 20.0f;
+        mirrored.x2 += 20.0f;
+        mirrored.track_id = RIGHT_ID_OFFSET;
+
+        if (!matcher.matchTracks({left}, {mirrored}).empty()) {
+            std::cerr << "banded: matched a right track with negative disparity" << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    const StereoCalibration calibration = makeCalibration();
+    const StereoRectifier rectifier(calibration);
+
+    EpipolarBand band;
+    band.max_disparity = static_cast<float>(IMAGE_WIDTH);
+
+    StereoMatcher greedy(IMAGE_WIDTH, MatchStrategy::Greedy);
+    StereoMatcher optimal(IMAGE_WIDTH, MatchStrategy::Optimal);
+    StereoMatcher banded_greedy(IMAGE_WIDTH, MatchStrategy::Greedy);
+    StereoMatcher banded_optimal(IMAGE_WIDTH, MatchStrategy::Optimal);
+    banded_greedy.setEpipolarBand(band);
+    banded_optimal.setEpipolarBand(band);
+
+    std::mt19937 rng(11);
+    for (int i = 0; i < SCENES; i++) {
+        const Scene scene = makeScene(calibration, rectifier, rng);
+        if (!checkDisparity(scene, rectifier) ||
+            !checkMatches("greedy", greedy, scene) ||
+            !checkMatches("optimal", optimal, scene) ||
+            !checkMatches("banded greedy", banded_greedy, scene) ||
+            !checkMatches("banded optimal", banded_optimal, scene) ||
+            !checkWrongSide(banded_optimal, scene)) {
+            return 1;
+        }
+    }
+
+    std::cout << "stereo matching ok on " << SCENES << " rectified scenes" << std::endl;
+    return 0;
+}
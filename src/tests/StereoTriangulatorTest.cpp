@@ -0,0 +1,161 @@
+// round trip through a synthetic stereo rig with a known baseline: known 3D points are projected
+// into both views, the boxes around them triangulated back, with and without a rectifier.
+// pairs on the wrong side of each other (negative disparity) must not produce an object
+#include "../StereoTriangulator.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace {
+    constexpr int IMAGE_WIDTH = 640;
+    constexpr int IMAGE_HEIGHT = 480;
+    constexpr double FOCAL_PX = 600.0;
+    constexpr double BASELINE = 0.12;           // m, right camera to the right of the left one
+    constexpr int POINT_COUNT = 50;
+    constexpr int RIGHT_ID_OFFSET = 100000;
+    constexpr float BOX_HALF_SIZE = 20.0f;
+    constexpr float RECTIFIED_TOLERANCE = 0.03f;    // of the depth, the rectification table is interpolated
+    constexpr float PINHOLE_TOLERANCE = 1e-3f;
+    constexpr int64_t FRAME_NS = 33'000'000;
+
+    StereoCalibration makeCalibration() {
+        StereoCalibration calibration;
+        calibration.image_size = cv::Size(IMAGE_WIDTH, IMAGE_HEIGHT);
+        calibration.M1 = (cv::Mat_<double>(3, 3) << FOCAL_PX, 0, IMAGE_WIDTH / 2.0,
+                                                    0, FOCAL_PX, IMAGE_HEIGHT / 2.0,
+                                                    0, 0, 1);
+        calibration.M2 = calibration.M1.clone();
+        calibration.D1 = cv::Mat::zeros(1, 5, CV_64F);
+        calibration.D2 = cv::Mat::zeros(1, 5, CV_64F);
+        calibration.R = cv::Mat::eye(3, 3, CV_64F);
+        // cv::stereoCalibrate convention, X_right = R * X_left + T
+        calibration.T = (cv::Mat_<double>(3, 1) << -BASELINE, 0.0, 0.0);
+        return calibration;
+    }
+
+    TrackingResult boxAround(const cv::Point2f& center, int track_id) {
+        return {center.x - BOX_HALF_SIZE, center.y - BOX_HALF_SIZE,
+                center.x + BOX_HALF_SIZE, center.y + BOX_HALF_SIZE, track_id, 0, 0.9f};
+    }
+
+    // visible in both views between 1.5 and 6 m
+    std::vector<cv::Point3f> makePoints(std::mt19937& rng) {
+        std::uniform_real_distribution<float> u_dist(120.0f, 600.0f);
+        std::uniform_real_distribution<float> v_dist(40.0f, 440.0f);
+        std::uniform_real_distribution<float> depth_dist(1.5f, 6.0f);
+
+        std::vector<cv::Point3f> points;
+        for (int i = 0; i < POINT_COUNT; i++) {
+            const float z = depth_dist(rng);
+            points.emplace_back((u_dist(rng) - IMAGE_WIDTH / 2.0f) * z / static_cast<float>(FOCAL_PX),
+                                (v_dist(rng) - IMAGE_HEIGHT / 2.0f) * z / static_cast<float>(FOCAL_PX), z);
+        }
+        return points;
+    }
+
+    // one track per point on each side, paired by index
+    void makeTracks(const std::vector<cv::Point2f>& left_px, const std::vector<cv::Point2f>& right_px,
+                    std::vector<TrackingResult>& left, std::vector<TrackingResult>& right,
+                    std::vector<StereoPair>& pairs) {
+        left.clear();
+        right.clear();
+        pairs.clear();
+        for (size_t i = 0; i < left_px.size(); i++) {
+            const int id = static_cast<int>(i);
+            left.push_back(boxAround(left_px[i], id));
+            right.push_back(boxAround(right_px[i], RIGHT_ID_OFFSET + id));
+            pairs.push_back({id, RIGHT_ID_OFFSET + id});
+        }
+    }
+
+    std::vector<StereoObject> triangulate(StereoTriangulator& triangulator,
+                                          const std::vector<TrackingResult>& left,
+                                          const std::vector<TrackingResult>& right,
+                                          const std::vector<StereoPair>& pairs) {
+        SuperIdRegistry super_ids;
+        super_ids.beginFrame(left, right);
+        super_ids.assign(pairs);
+        return triangulator.update(pairs, left, right, super_ids, FRAME_NS);
+    }
+
+    bool checkRoundTrip(const char* name, const std::vector<StereoObject>& objects,
+                        const std::vector<cv::Point3f>& points, float tolerance) {
+        if (objects.size() != points.size()) {
+            std::cerr << name << ": triangulated " << objects.size() << " of " << points.size()
+                      << " points" << std::endl;
+            return false;
+        }
+        for (const auto& object : objects) {
+            const cv::Point3f& expected = points[object.left_id];
+            const float error = static_cast<float>(cv::norm(object.measured - expected));
+            if (object.disparity <= 0.0f || error > tolerance * expected.z) {
+                std::cerr << name << ": point " << object.left_id << " at " << expected
+                          << " came back as " << object.measured << " (disparity " << object.disparity
+                          << " px)" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // swapping the views turns every disparity negative
+    bool checkWrongSide(const char* name, StereoTriangulator& triangulator,
+                        const std::vector<cv::Point2f>& left_px, const std::vector<cv::Point2f>& right_px) {
+        std::vector<TrackingResult> left, right;
+        std::vector<StereoPair> pairs;
+        makeTracks(right_px, left_px, left, right, pairs);
+        const std::vector<StereoObject> objects = triangulate(triangulator, left, right, pairs);
+        if (!objects.empty()) {
+            std::cerr << name << ": triangulated " << objects.size()
+                      << " pairs with negative disparity" << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+int main() {
+    std::mt19937 rng(5);
+    const std::vector<cv::Point3f> points = makePoints(rng);
+    const StereoCalibration calibration = makeCalibration();
+
+    std::vector<cv::Point2f> left_px, right_px;
+    const cv::Mat no_rotation = cv::Mat::zeros(3, 1, CV_64F);
+    cv::projectPoints(points, no_rotation, cv::Mat::zeros(3, 1, CV_64F),
+                      calibration.M1, calibration.D1, left_px);
+    cv::projectPoints(points, no_rotation, calibration.T, calibration.M2, calibration.D2, right_px);
+
+    std::vector<TrackingResult> left, right;
+    std::vector<StereoPair> pairs;
+
+    // calibrated: boxes go through the rectifier first, depth comes from its Q
+    const StereoRectifier rectifier(calibration);
+    StereoTriangulator rectified(&rectifier);
+    makeTracks(left_px, right_px, left, right, pairs);
+    rectifier.rectify(StereoRectifier::Side::Left, left);
+    rectifier.rectify(StereoRectifier::Side::Right, right);
+    if (!checkRoundTrip("rectified", triangulate(rectified, left, right, pairs), points, RECTIFIED_TOLERANCE)) {
+        return 1;
+    }
+
+    // uncalibrated: pinhole geometry of the same rig
+    StereoGeometry geometry;
+    geometry.focal_px = static_cast<float>(FOCAL_PX);
+    geometry.baseline = static_cast<float>(BASELINE);
+    geometry.principal_point = cv::Point2f(IMAGE_WIDTH / 2.0f, IMAGE_HEIGHT / 2.0f);
+    StereoTriangulator pinhole(nullptr, geometry);
+    makeTracks(left_px, right_px, left, right, pairs);
+    if (!checkRoundTrip("pinhole", triangulate(pinhole, left, right, pairs), points, PINHOLE_TOLERANCE)) {
+        return 1;
+    }
+
+    StereoTriangulator rectified_swapped(&rectifier);
+    StereoTriangulator pinhole_swapped(nullptr, geometry);
+    if (!checkWrongSide("rectified", rectified_swapped, left_px, right_px) ||
+        !checkWrongSide("pinhole", pinhole_swapped, left_px, right_px)) {
+        return 1;
+    }
+
+    std::cout << "stereo triangulation round trip ok on " << POINT_COUNT << " points" << std::endl;
+    return 0;
+}
@@ -0,0 +1,313 @@
+// accuracy check of a quantized (or otherwise converted) model against its float32 original on a
+// labeled clip: mAP@0.5, mAP@0.5:0.95 and recall at the detector's operating threshold for both,
+// plus the drift between them and the inference time of each.
+//
+// the clip is an image directory with YOLO labels: one "class cx cy w h" line per object,
+// normalized to the image size, in a .txt next to each image or in --labels. without any label
+// files the float32 model's detections above the operating threshold serve as the ground truth.
+//
+// usage: visionary_validate --images <dir> [--labels <dir>] --reference <fp32.onnx> --candidate <int8.onnx>
+//                           [--engine opencv|openvino|onnxruntime] [--threads N]
+#include "../YoloDetector.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+
+namespace {
+    namespace fs = std::filesystem;
+
+    constexpr float EVAL_CONFIDENCE = 0.001f;       // keep the low-score tail, AP integrates over it
+    constexpr float OPERATING_CONFIDENCE = 0.4f;    // what the detection executable runs with
+    constexpr float NMS_THRESHOLD = 0.4f;
+    constexpr float RECALL_IOU = 0.5f;
+    constexpr double MAX_MAP_DROP = 0.01;           // flagged above one point of mAP@0.5
+
+    struct Box {
+        float x1, y1, x2, y2;
+        int class_id;
+    };
+
+    struct ScoredBox {
+        Box box;
+        float score;
+    };
+
+    struct Options {
+        std::string images;
+        std::string labels;         // empty: next to the images
+        std::string reference;
+        std::string candidate;
+        InferenceOptions inference;
+    };
+
+    struct ModelRun {
+        std::vector<std::vector<ScoredBox>> detections;    // per image
+        double mean_inference_ms = 0.0;
+    };
+
+    struct Evaluation {
+        double map50 = 0.0;
+        double map50_95 = 0.0;
+        double recall = 0.0;        // at OPERATING_CONFIDENCE and IoU 0.5
+    };
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+            const std::string value = argv[++i];
+            if (arg == "--images") options.images = value;
+            else if (arg == "--labels") options.labels = value;
+            else if (arg == "--reference") options.reference = value;
+            else if (arg == "--candidate") options.candidate = value;
+            else if (arg == "--engine") options.inference.engine = InferenceBackend::parseEngine(value);
+            else if (arg == "--threads") options.inference.threads = std::stoi(value);
+            else throw std::runtime_error("Unknown argument " + arg);
+        }
+        if (options.images.empty() || options.reference.empty() || options.candidate.empty()) {
+            throw std::runtime_error("--images, --reference and --candidate are required");
+        }
+        return options;
+    }
+
+    std::vector<fs::path> listImages(const std::string& directory) {
+        static const std::vector<std::string> IMAGE_EXTENSIONS = {".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff"};
+
+        std::vector<fs::path> images;
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            std::string extension = entry.path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (entry.is_regular_file() &&
+                std::find(IMAGE_EXTENSIONS.begin(), IMAGE_EXTENSIONS.end(), extension) != IMAGE_EXTENSIONS.end()) {
+                images.push_back(entry.path());
+            }
+        }
+        std::sort(images.begin(), images.end());
+        return images;
+    }
+
+    // false if the image has no label file
+    bool loadLabels(const fs::path& label_path, const cv::Size& image_size, std::vector<Box>& out) {
+        std::ifstream file(label_path);
+        if (!file) return false;
+
+        int class_id;
+        float cx, cy, w, h;
+        while (file >> class_id >> cx >> cy >> w >> h) {
+            out.push_back({(cx - w / 2) * image_size.width, (cy - h / 2) * image_size.height,
+                           (cx + w / 2) * image_size.width, (cy + h / 2) * image_size.height, class_id});
+        }
+        return true;
+    }
+
+    float iou(const Box& a, const Box& b) {
+        float w = std::min(a.x2, b.x2) - std::max(a.x1, b.x1);
+        float h = std::min(a.y2, b.y2) - std::max(a.y1, b.y1);
+        if (w <= 0.0f || h <= 0.0f) return 0.0f;
+        float inter = w * h;
+        return inter / ((a.x2 - a.x1) * (a.y2 - a.y1) + (b.x2 - b.x1) * (b.y2 - b.y1) - inter);
+    }
+
+    ModelRun runModel(const std::string& model_path, const InferenceOptions& inference,
+                      const std::vector<cv::Mat>& images) {
+        YoloDetector detector(model_path, EVAL_CONFIDENCE, NMS_THRESHOLD,
+                              YoloDetector::PreprocessMode::Letterbox, inference);
+        std::cout << model_path << ": " << detector.describeBackend() << std::endl;
+
+        ModelRun run;
+        double inference_ms = 0.0;
+        for (const cv::Mat& image : images) {
+            std::vector<ScoredBox> boxes;
+            for (const auto& det : detector.detect(image)) {
+                boxes.push_back({{det.x1, det.y1, det.x2, det.y2, det.class_id}, det.confidence});
+            }
+            run.detections.push_back(std::move(boxes));
+            inference_ms += detector.lastTimings().inference_ms;
+        }
+        run.mean_inference_ms = inference_ms / std::max<size_t>(1, images.size());
+        return run;
+    }
+
+    // all-point interpolated AP of one class at one IoU threshold (greedy matching by score)
+    double averagePrecision(const std::vector<std::vector<Box>>& truth, const ModelRun& run,
+                            int class_id, float iou_threshold, size_t truth_count) {
+        struct Candidate {
+            float score;
+            size_t image;
+            const Box* box;
+        };
+        std::vector<Candidate> candidates;
+        for (size_t i = 0; i < run.detections.size(); i++) {
+            for (const auto& det : run.detections[i]) {
+                if (det.box.class_id == class_id) candidates.push_back({det.score, i, &det.box});
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+        std::vector<std::vector<bool>> taken(truth.size());
+        for (size_t i = 0; i < truth.size(); i++) taken[i].assign(truth[i].size(), false);
+
+        std::vector<double> precision, recall;
+        size_t true_positives = 0;
+        for (size_t k = 0; k < candidates.size(); k++) {
+            const Candidate& candidate = candidates[k];
+            const auto& boxes = truth[candidate.image];
+            int best = -1;
+            float best_iou = iou_threshold;
+            for (size_t g = 0; g < boxes.size(); g++) {
+                if (boxes[g].class_id != class_id || taken[candidate.image][g]) continue;
+                float overlap = iou(*candidate.box, boxes[g]);
+                if (overlap >= best_iou) {
+                    best_iou = overlap;
+                    best = static_cast<int>(g);
+                }
+            }
+            if (best >= 0) {
+                taken[candidate.image][best] = true;
+                true_positives++;
+            }
+            precision.push_back(static_cast<double>(true_positives) / (k + 1));
+            recall.push_back(static_cast<double>(true_positives) / truth_count);
+        }
+
+        // area under the precision envelope
+        for (size_t k = precision.size(); k-- > 1;) precision[k - 1] = std::max(precision[k - 1], precision[k]);
+        double ap = 0.0, previous_recall = 0.0;
+        for (size_t k = 0; k < precision.size(); k++) {
+            ap += (recall[k] - previous_recall) * precision[k];
+            previous_recall = recall[k];
+        }
+        return ap;
+    }
+
+    Evaluation evaluate(const std::vector<std::vector<Box>>& truth, const ModelRun& run) {
+        std::map<int, size_t> truth_per_class;
+        size_t truth_total = 0;
+        for (const auto& boxes : truth) {
+            for (const auto& box : boxes) truth_per_class[box.class_id]++;
+            truth_total += boxes.size();
+        }
+
+        Evaluation evaluation;
+        if (truth_per_class.empty()) return evaluation;
+
+        for (const auto& [class_id, count] : truth_per_class) {
+            double sum = 0.0;
+            for (int step = 0; step < 10; step++) {
+                double ap = averagePrecision(truth, run, class_id, 0.5f + 0.05f * step, count);
+                if (step == 0) evaluation.map50 += ap;
+                sum += ap;
+            }
+            evaluation.map50_95 += sum / 10.0;
+        }
+        evaluation.map50 /= truth_per_class.size();
+        evaluation.map50_95 /= truth_per_class.size();
+
+        // recall at the operating point: ground truth covered by a same-class detection the app would keep
+        size_t found = 0;
+        for (size_t i = 0; i < truth.size(); i++) {
+            for (const auto& box : truth[i]) {
+                for (const auto& det : run.detections[i]) {
+                    if (det.score >= OPERATING_CONFIDENCE && det.box.class_id == box.class_id &&
+                        iou(det.box, box) >= RECALL_IOU) {
+                        found++;
+                        break;
+                    }
+                }
+            }
+        }
+        evaluation.recall = static_cast<double>(found) / truth_total;
+        return evaluation;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    try {
+        options = parseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\nusage: visionary_validate --images <dir> [--labels <dir>] --reference <fp32.onnx>"
+                                 " --candidate <model.onnx> [--engine opencv|openvino|onnxruntime] [--threads N]"
+                  << std::endl;
+        return 2;
+    }
+
+    std::vector<cv::Mat> images;
+    std::vector<std::vector<Box>> truth;
+    size_t labeled = 0;
+    for (const fs::path& path : listImages(options.images)) {
+        cv::Mat image = cv::imread(path.string(), cv::IMREAD_COLOR);
+        if (image.empty()) {
+            std::cerr << "Skipping unreadable image " << path.string() << std::endl;
+            continue;
+        }
+        fs::path label_path = path;
+        label_path.replace_extension(".txt");
+        if (!options.labels.empty()) label_path = fs::path(options.labels) / label_path.filename();
+
+        truth.emplace_back();
+        if (loadLabels(label_path, image.size(), truth.back())) labeled++;
+        images.push_back(std::move(image));
+    }
+    if (images.empty()) {
+        std::cerr << "No images in " << options.images << std::endl;
+        return 1;
+    }
+
+    ModelRun reference, candidate;
+    try {
+        reference = runModel(options.reference, options.inference, images);
+        candidate = runModel(options.candidate, options.inference, images);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (labeled == 0) {
+        std::cout << "No label files found, using the reference model's detections above "
+                  << OPERATING_CONFIDENCE << " as ground truth" << std::endl;
+        for (size_t i = 0; i < images.size(); i++) {
+            for (const auto& det : reference.detections[i]) {
+                if (det.score >= OPERATING_CONFIDENCE) truth[i].push_back(det.box);
+            }
+        }
+    } else if (labeled < images.size()) {
+        std::cout << images.size() - labeled << " of " << images.size()
+                  << " images have no label file and count as empty" << std::endl;
+    }
+
+    const Evaluation reference_eval = evaluate(truth, reference);
+    const Evaluation candidate_eval = evaluate(truth, candidate);
+
+    std::cout << "\n" << images.size() << " images\n" << std::fixed << std::setprecision(4)
+              << std::left << std::setw(12) << "" << std::right
+              << std::setw(12) << "mAP@0.5" << std::setw(14) << "mAP@.5:.95"
+              << std::setw(10) << "recall" << std::setw(14) << "infer ms\n"
+              << std::left << std::setw(12) << "reference" << std::right
+              << std::setw(12) << reference_eval.map50 << std::setw(14) << reference_eval.map50_95
+              << std::setw(10) << reference_eval.recall << std::setw(13) << reference.mean_inference_ms << "\n"
+              << std::left << std::setw(12) << "candidate" << std::right
+              << std::setw(12) << candidate_eval.map50 << std::setw(14) << candidate_eval.map50_95
+              << std::setw(10) << candidate_eval.recall << std::setw(13) << candidate.mean_inference_ms << "\n"
+              << std::left << std::setw(12) << "drift" << std::right << std::showpos
+              << std::setw(12) << candidate_eval.map50 - reference_eval.map50
+              << std::setw(14) << candidate_eval.map50_95 - reference_eval.map50_95
+              << std::setw(10) << candidate_eval.recall - reference_eval.recall << std::noshowpos
+              << std::setw(12) << std::setprecision(2) << reference.mean_inference_ms / candidate.mean_inference_ms
+              << "x\n" << std::endl;
+
+    // a non-zero exit lets a model export script reject the candidate
+    if (reference_eval.map50 - candidate_eval.map50 > MAX_MAP_DROP) {
+        std::cout << "candidate loses more than " << MAX_MAP_DROP * 100 << " points of mAP@0.5" << std::endl;
+        return 3;
+    }
+    return 0;
+}
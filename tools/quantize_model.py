@@ -0,0 +1,128 @@
+"""Builds INT8 (QDQ) and FP16 variants of a YOLO ONNX model for the detection executable.
+
+INT8 calibrates the activation ranges on a folder of sample frames. The frames are preprocessed
+exactly like YoloDetector does it: letterboxed to 640x640 with gray (114) padding, RGB, scaled
+by 1/255. Both variants keep float32 inputs and outputs, so every inference engine loads them
+like the original model.
+
+usage:
+    python quantize_model.py int8 assets/yolov9-m.onnx assets/yolov9-m-int8.onnx --calibration frames/
+    python quantize_model.py fp16 assets/yolov9-m.onnx assets/yolov9-m-fp16.onnx
+
+Check the result with visionary_validate before deploying it.
+"""
+import argparse
+import pathlib
+import random
+import tempfile
+
+import cv2
+import numpy as np
+import onnx
+
+INPUT_SIZE = 640
+LETTERBOX_FILL = 114
+IMAGE_EXTENSIONS = {".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff"}
+
+
+def letterbox_blob(image):
+    """BGR image -> (1, 3, 640, 640) float32 blob, like YoloDetector::fillInputPlane."""
+    height, width = image.shape[:2]
+    ratio = min(INPUT_SIZE / width, INPUT_SIZE / height)
+    content_w = min(INPUT_SIZE, round(width * ratio))
+    content_h = min(INPUT_SIZE, round(height * ratio))
+    pad_x = (INPUT_SIZE - content_w) // 2
+    pad_y = (INPUT_SIZE - content_h) // 2
+
+    canvas = np.full((INPUT_SIZE, INPUT_SIZE, 3), LETTERBOX_FILL, dtype=np.uint8)
+    canvas[pad_y:pad_y + content_h, pad_x:pad_x + content_w] = cv2.resize(
+        image, (content_w, content_h), interpolation=cv2.INTER_LINEAR)
+
+    rgb = cv2.cvtColor(canvas, cv2.COLOR_BGR2RGB).astype(np.float32) / 255.0
+    return np.ascontiguousarray(rgb.transpose(2, 0, 1)[np.newaxis])
+
+
+def sample_frames(directory, count, seed):
+    files = sorted(p for p in pathlib.Path(directory).iterdir() if p.suffix.lower() in IMAGE_EXTENSIONS)
+    if not files:
+        raise SystemExit(f"no images in {directory}")
+    if len(files) > count:
+        # spread over the whole clip rather than its first seconds
+        files = sorted(random.Random(seed).sample(files, count))
+    return files
+
+
+def quantize_int8(source, target, args):
+    from onnxruntime.quantization import (CalibrationDataReader, CalibrationMethod, QuantFormat,
+                                          QuantType, quantize_static)
+    from onnxruntime.quantization.shape_inference import quant_pre_process
+
+    class FrameReader(CalibrationDataReader):
+        def __init__(self, files, input_name):
+            self.files = iter(files)
+            self.input_name = input_name
+
+        def get_next(self):
+            for path in self.files:
+                image = cv2.imread(str(path), cv2.IMREAD_COLOR)
+                if image is not None:
+                    return {self.input_name: letterbox_blob(image)}
+                print(f"skipping unreadable image {path}")
+            return None
+
+    files = sample_frames(args.calibration, args.samples, args.seed)
+    input_name = onnx.load(str(source), load_external_data=False).graph.input[0].name
+    methods = {
+        "minmax": CalibrationMethod.MinMax,
+        "entropy": CalibrationMethod.Entropy,
+        "percentile": CalibrationMethod.Percentile,
+    }
+
+    with tempfile.TemporaryDirectory() as scratch:
+        # shape inference and graph cleanup first, as onnxruntime recommends for static quantization
+        prepared = pathlib.Path(scratch) / "prepared.onnx"
+        quant_pre_process(str(source), str(prepared))
+
+        print(f"calibrating on {len(files)} frames from {args.calibration} ({args.method})")
+        quantize_static(
+            str(prepared), str(target), FrameReader(files, input_name),
+            quant_format=QuantFormat.QDQ,
+            activation_type=QuantType.QUInt8,
+            weight_type=QuantType.QInt8,
+            per_channel=True,
+            calibrate_method=methods[args.method],
+            # the box/score decode at the end of the head stays in float, it is tiny and
+            # the most sensitive part of the network
+            op_types_to_quantize=["Conv", "MatMul"],
+        )
+
+
+def convert_fp16(source, target):
+    from onnxconverter_common import float16
+
+    model = float16.convert_float_to_float16(onnx.load(str(source)), keep_io_types=True)
+    onnx.save(model, str(target))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("precision", choices=["int8", "fp16"])
+    parser.add_argument("source", type=pathlib.Path, help="float32 model")
+    parser.add_argument("target", type=pathlib.Path)
+    parser.add_argument("--calibration", help="folder of sample frames (int8 only)")
+    parser.add_argument("--samples", type=int, default=200, help="calibration frames to use")
+    parser.add_argument("--method", choices=["minmax", "entropy", "percentile"], default="minmax")
+    parser.add_argument("--seed", type=int, default=0)
+    args = parser.parse_args()
+
+    if args.precision == "int8":
+        if not args.calibration:
+            parser.error("int8 needs --calibration <folder of frames>")
+        quantize_int8(args.source, args.target, args)
+    else:
+        convert_fp16(args.source, args.target)
+    print(f"wrote {args.target}")
+
+
+if __name__ == "__main__":
+    main()